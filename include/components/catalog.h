@@ -0,0 +1,90 @@
+// Path: include/components/catalog.h
+#ifndef __3D_SCANNER_CATALOG_H__
+#define __3D_SCANNER_CATALOG_H__
+
+#include <Arduino.h>
+
+#include <FS.h>
+
+#include "esp_log.h"
+
+#include "components/recorder.h"
+
+#define CATALOG_TAG_NAME "catalog"
+
+#define CATALOG_PATH RECORDER_DIR "/catalog.db"
+
+// Open addressing on the file name, a power of two. One slot stays free so every probe ends
+#define CATALOG_SLOTS 512
+// Slots read from the card at once while listing
+#define CATALOG_READ_SLOTS 4
+// Longest wait for the catalogue file, the recorder task holds it for a single slot write
+#define CATALOG_LOCK_MS 1000
+
+#define CATALOG_STATE_EMPTY       0
+#define CATALOG_STATE_RECORDING   1
+#define CATALOG_STATE_DONE        2
+// Still recording when the ESP32 restarted, a `resume` continues it
+#define CATALOG_STATE_INTERRUPTED 3
+
+#define CATALOG_REMOVE_OK        0
+#define CATALOG_REMOVE_NOT_FOUND 1
+#define CATALOG_REMOVE_BUSY      2
+#define CATALOG_REMOVE_ERROR     3
+
+// One slot of CATALOG_PATH, little endian
+typedef struct __attribute__((packed)) {
+    char name[RECORDER_NAME_LENGTH];    // the project name, slots are found by its file name
+    uint8_t state;                      // CATALOG_STATE_*
+    uint8_t reserved[3];
+    uint32_t records;
+    uint32_t surface;                   // records that are not no surface points
+    uint32_t duration_ms;               // time spent recording, over all resumes
+    // Bounding box of the surface points in 0.01 mm, min above max while there are none
+    int32_t min_x;
+    int32_t min_y;
+    int32_t min_z;
+    int32_t max_x;
+    int32_t max_y;
+    int32_t max_z;
+    // <name>.bin holds the records from data_offset to data_end, <name>.idx ends at index_end
+    uint32_t data_offset;
+    uint32_t data_end;
+    uint32_t index_end;
+    // get_module() when the recording started
+    uint16_t z_axis_max;
+    uint16_t z_axis_start_step;
+    uint16_t z_axis_delay_time;
+    uint16_t z_axis_one_time_step;
+    uint16_t x_y_axis_max;
+    uint16_t x_y_axis_check_times;
+    uint16_t x_y_axis_step_delay_time;
+    uint16_t x_y_axis_one_time_step;
+    uint16_t vl53l1x_center;
+    uint16_t vl53l1x_timeing_budget;
+} catalog_entry_t;
+
+// Cursor of a listing, `slot` is the next slot to hand out
+typedef struct {
+    uint16_t slot;
+    catalog_entry_t block[CATALOG_READ_SLOTS];
+    uint16_t block_first;
+    uint8_t block_count;
+} catalog_list_t;
+
+bool init_catalog();
+
+void catalog_begin(catalog_entry_t* entry, const char* name);
+void catalog_add_records(catalog_entry_t* entry, const recorder_record_t* records, size_t count);
+void catalog_clear_records(catalog_entry_t* entry);
+
+bool catalog_put(const catalog_entry_t* entry);
+bool catalog_get(const char* name, catalog_entry_t* entry);
+uint8_t catalog_remove(const char* name);
+
+void catalog_list_begin(catalog_list_t* list);
+bool catalog_list_next(catalog_list_t* list, catalog_entry_t* entry);
+
+const char* catalog_state_name(uint8_t state);
+
+#endif // __3D_SCANNER_CATALOG_H__
@@ -0,0 +1,53 @@
+// Path: include/components/codec.h
+#ifndef __3D_SCANNER_CODEC_H__
+#define __3D_SCANNER_CODEC_H__
+
+// Plain C types only, so a client can build the same encoder and decoder off target
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Ring body: uint16 start angle, uint16 angle step, then one symbol per point
+#define CODEC_RING_HEADER_BYTES 4
+// Most bytes one point can add: an r symbol, a dz varint and a pending run of zeros
+#define CODEC_RING_POINT_BYTES  9
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t* buffer;
+    size_t size;
+    size_t length;
+    uint16_t count;
+    uint16_t last_angle;
+    uint16_t step;
+    uint16_t last_r;
+    uint16_t zero_run;      // r deltas of 0 not written yet
+    bool rle;               // runs of r deltas of 0 become one symbol
+    bool dz;                // every point carries its own dz after its r
+} codec_ring_encoder_t;
+
+void codec_ring_begin(codec_ring_encoder_t* encoder, uint8_t* buffer, size_t size, bool rle, bool dz);
+bool codec_ring_add(codec_ring_encoder_t* encoder, uint16_t angle, uint16_t r, int16_t dz);
+size_t codec_ring_end(codec_ring_encoder_t* encoder);
+bool codec_ring_decode(const uint8_t* data, size_t length, uint16_t count, bool rle, bool dz,
+                       uint16_t* angles, uint16_t* r, int16_t* dz_values);
+
+size_t codec_put_varint(uint8_t* buffer, uint32_t value);
+size_t codec_get_varint(const uint8_t* buffer, size_t length, uint32_t* value);
+
+static inline uint32_t codec_zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t codec_unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __3D_SCANNER_CODEC_H__
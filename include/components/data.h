@@ -64,6 +64,15 @@
 #define NVS_Z_AXIS_DELAY_TIME_DEFAULT     100
 #define NVS_Z_AXIS_ONE_TIME_STEP_DEFAULT  400
 
+#define NVS_Z_AXIS_MAX_SPEED    "ZMV"
+#define NVS_Z_AXIS_ACCELERATION "ZA"
+#define NVS_Z_AXIS_JERK         "ZJ"
+
+// steps/s, steps/s^2 and steps/s^3, a jerk of 0 gives a trapezoidal profile
+#define NVS_Z_AXIS_MAX_SPEED_DEFAULT    10000
+#define NVS_Z_AXIS_ACCELERATION_DEFAULT 20000
+#define NVS_Z_AXIS_JERK_DEFAULT             0
+
 #define NVS_X_Y_AXIS_MAX             "2M"
 #define NVS_X_Y_AXIS_CHECK_TIMES     "2CT"
 #define NVS_X_Y_AXIS_STEP_DELAY_TIME "2STD"
@@ -74,6 +83,14 @@
 #define NVS_X_Y_AXIS_STEP_DELAY_TIME_DEFAULT   50
 #define NVS_X_Y_AXIS_ONE_TIME_STEP_DEFAULT      8
 
+#define NVS_X_Y_AXIS_MAX_SPEED    "2MV"
+#define NVS_X_Y_AXIS_ACCELERATION "2A"
+#define NVS_X_Y_AXIS_JERK         "2J"
+
+#define NVS_X_Y_AXIS_MAX_SPEED_DEFAULT    16000
+#define NVS_X_Y_AXIS_ACCELERATION_DEFAULT 40000
+#define NVS_X_Y_AXIS_JERK_DEFAULT             0
+
 #define NVS_VL53L1X_CENTER         "R_C"
 #define NVS_VL53L1X_TIMEING_BUDGET "R_TB"
 
@@ -81,6 +98,66 @@
 // Valid timing budgets: 15, 20, 33, 50, 100, 200 and 500ms!
 #define NVS_VL53L1X_TIMEING_BUDGET_DEFAULT    200 
 
+// Stream
+
+#define NVS_STREAM_BATCH_POINTS "SBP"
+#define NVS_STREAM_BATCH_BYTES  "SBB"
+#define NVS_STREAM_BATCH_TIME   "SBT"
+#define NVS_STREAM_BATCH_RING   "SBR"
+#define NVS_STREAM_STATUS_TIME  "SST"
+
+#define NVS_STREAM_BATCH_POINTS_DEFAULT   32
+#define NVS_STREAM_BATCH_BYTES_DEFAULT  4096
+#define NVS_STREAM_BATCH_TIME_DEFAULT    500
+#define NVS_STREAM_BATCH_RING_DEFAULT      1
+#define NVS_STREAM_STATUS_TIME_DEFAULT   500
+
+// Sampling
+
+#define NVS_SAMPLE_BOUND "SMB"
+#define NVS_SAMPLE_MIN   "SMN"
+#define NVS_SAMPLE_MAX   "SMX"
+
+// Confidence bound in 0.01 mm, 0 takes x_y_axis_check_times samples for every point
+#define NVS_SAMPLE_BOUND_DEFAULT  0
+#define NVS_SAMPLE_MIN_DEFAULT    3
+#define NVS_SAMPLE_MAX_DEFAULT   16
+
+// Point filter
+
+#define NVS_FILTER_WINDOW  "FWN"
+#define NVS_FILTER_OUTLIER "FOL"
+#define NVS_FILTER_RING    "FRG"
+#define NVS_FILTER_SMOOTH  "FSM"
+#define NVS_FILTER_DROP    "FDR"
+
+// Off, a window of 5 points, 2 mm off the neighbours or 5 mm off the previous ring is suspect
+#define NVS_FILTER_WINDOW_DEFAULT    0
+#define NVS_FILTER_OUTLIER_DEFAULT 200
+#define NVS_FILTER_RING_DEFAULT    500
+#define NVS_FILTER_SMOOTH_DEFAULT    1
+#define NVS_FILTER_DROP_DEFAULT      0
+
+// Voxel grid, edge in 0.01 mm, 0 sends every point
+
+#define NVS_VOXEL_SIZE "VXS"
+
+#define NVS_VOXEL_SIZE_DEFAULT 0
+
+// Scan checkpoint
+
+#define NVS_CHECKPOINT "CKP"
+
+// VL53L1X multi zone, distance offset in mm of every zone
+
+#define NVS_ZONE_OFFSETS "VZO"
+
+#define NVS_ZONE_OFFSET_DEFAULT 0
+
+// VL53 sensors, count and mounting, one sensor if not set
+
+#define NVS_VL53_SENSORS "VSC"
+
 // Functions 
 
 void init_nvs();
@@ -104,4 +181,31 @@ void get_module(uint16_t* z_axis_max, uint16_t* z_axis_start_step, uint16_t* z_a
                 uint16_t* x_y_axis_max, uint16_t* x_y_axis_check_times, uint16_t* x_y_axis_step_delay_time, uint16_t* x_y_axis_one_time_step,
                 uint16_t* vl53l1x_center, uint16_t* vl53l1x_timeing_budget);
 
+void set_motion(uint32_t z_axis_max_speed, uint32_t z_axis_acceleration, uint32_t z_axis_jerk,
+                uint32_t x_y_axis_max_speed, uint32_t x_y_axis_acceleration, uint32_t x_y_axis_jerk);
+void get_motion(uint32_t* z_axis_max_speed, uint32_t* z_axis_acceleration, uint32_t* z_axis_jerk,
+                uint32_t* x_y_axis_max_speed, uint32_t* x_y_axis_acceleration, uint32_t* x_y_axis_jerk);
+
+void set_stream(uint16_t batch_points, uint16_t batch_bytes, uint16_t batch_time, uint8_t batch_ring, uint16_t status_time);
+void get_stream(uint16_t* batch_points, uint16_t* batch_bytes, uint16_t* batch_time, uint8_t* batch_ring, uint16_t* status_time);
+
+void set_sampling(uint16_t sample_bound, uint16_t sample_min, uint16_t sample_max);
+void get_sampling(uint16_t* sample_bound, uint16_t* sample_min, uint16_t* sample_max);
+
+void set_filter(uint8_t window, uint16_t outlier, uint16_t ring, uint8_t smooth, uint8_t drop);
+void get_filter(uint8_t* window, uint16_t* outlier, uint16_t* ring, uint8_t* smooth, uint8_t* drop);
+
+void set_voxel(uint16_t size);
+void get_voxel(uint16_t* size);
+
+void set_zone_offsets(const int16_t* offsets, uint8_t count);
+void get_zone_offsets(int16_t* offsets, uint8_t count);
+
+void set_vl53_sensors(const void* sensors, size_t length);
+size_t get_vl53_sensors(void* sensors, size_t length);
+
+void set_checkpoint(const void* checkpoint, size_t length);
+bool get_checkpoint(void* checkpoint, size_t length);
+void clear_checkpoint();
+
 #endif // __3D_SCANNER_DATA_H__
@@ -0,0 +1,46 @@
+// Path: include/components/estimator.h
+#ifndef __3D_SCANNER_ESTIMATOR_H__
+#define __3D_SCANNER_ESTIMATOR_H__
+
+#include <Arduino.h>
+
+#include "esp_log.h"
+
+#define ESTIMATOR_TAG_NAME "estimator"
+
+#define ESTIMATOR_MODE         0
+#define ESTIMATOR_MEDIAN       1
+#define ESTIMATOR_TRIMMED_MEAN 2
+
+// Samples of one point, more check times are clamped
+#define ESTIMATOR_MAX_SAMPLES  64
+// Histogram of the distance window, a wider window groups several mm per bin
+#define ESTIMATOR_BINS         256
+// Dropped from each end of the sorted samples by the trimmed mean
+#define ESTIMATOR_TRIM_PERCENT 25
+// Standard errors between the mean and the confidence bound, about 95 %
+#define ESTIMATOR_CONFIDENCE_Z 2.0f
+
+typedef struct {
+    uint8_t type;
+    uint16_t min;
+    uint16_t max;
+    uint16_t bin_width;
+    uint16_t count;
+    float mean;
+    float m2;               // sum of squared differences from the mean
+    uint16_t mode_bin;      // the fullest bin so far, the lowest one on a tie
+    uint16_t samples[ESTIMATOR_MAX_SAMPLES];
+    uint8_t histogram[ESTIMATOR_BINS];
+} estimator_t;
+
+void estimator_begin(estimator_t* estimator, uint8_t type, uint16_t min, uint16_t max);
+bool estimator_add(estimator_t* estimator, uint16_t sample);
+uint16_t estimator_count(const estimator_t* estimator);
+uint16_t estimator_result(estimator_t* estimator);
+float estimator_variance(const estimator_t* estimator);
+bool estimator_confident(const estimator_t* estimator, float bound);
+
+uint8_t estimator_from_name(const char* name);
+
+#endif // __3D_SCANNER_ESTIMATOR_H__
@@ -0,0 +1,55 @@
+// Path: include/components/exporter.h
+#ifndef __3D_SCANNER_EXPORTER_H__
+#define __3D_SCANNER_EXPORTER_H__
+
+#include <Arduino.h>
+
+#include <FS.h>
+
+#include "esp_log.h"
+
+#include "components/recorder.h"
+
+#define EXPORTER_TAG_NAME "exporter"
+
+// Picked with ?format=raw | ply | ply_ascii | xyz
+#define EXPORTER_FORMAT_RAW       0
+#define EXPORTER_FORMAT_PLY       1
+#define EXPORTER_FORMAT_PLY_ASCII 2
+#define EXPORTER_FORMAT_XYZ       3
+
+// Records read from the card at once, as many as fit in one SD block
+#define EXPORTER_READ_RECORDS (512 / sizeof(recorder_record_t))
+// Room for the PLY header, the longest piece of output
+#define EXPORTER_PENDING_SIZE 256
+
+// State of one download, lives from the request until the client disconnects
+typedef struct {
+    File file;
+    uint8_t format;
+    uint8_t record_size;    // of the recording, older ones are widened while reading
+    uint32_t records;
+    uint32_t surface;
+    char name[RECORDER_NAME_LENGTH];
+    // Output offset of the first byte of `pending`, and the next record to turn into output
+    size_t offset;
+    uint32_t record;
+    bool header_done;
+    char pending[EXPORTER_PENDING_SIZE];
+    uint16_t pending_length;
+    uint16_t pending_sent;
+    recorder_record_t block[EXPORTER_READ_RECORDS];
+    uint16_t block_count;
+    uint16_t block_next;
+} exporter_t;
+
+bool exporter_open(exporter_t* exporter, const char* name, uint8_t format);
+size_t exporter_length(const exporter_t* exporter);
+size_t exporter_read(exporter_t* exporter, uint8_t* buffer, size_t max_length, size_t offset);
+void exporter_close(exporter_t* exporter);
+
+uint8_t exporter_format_from_name(const char* name);
+const char* exporter_content_type(uint8_t format);
+const char* exporter_extension(uint8_t format);
+
+#endif // __3D_SCANNER_EXPORTER_H__
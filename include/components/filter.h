@@ -0,0 +1,45 @@
+// Path: include/components/filter.h
+#ifndef __3D_SCANNER_FILTER_H__
+#define __3D_SCANNER_FILTER_H__
+
+#include <Arduino.h>
+
+#include "esp_log.h"
+
+#include "components/points.h"
+
+#define FILTER_TAG_NAME "filter"
+
+// Points of a ring around the judged one, odd, larger windows are clamped
+#define FILTER_WINDOW_MAX 7
+// Angle bins of the previous ring, a bin holds the radius of the last point that fell in it
+#define FILTER_RING_BINS  256
+// Deviations from the neighbour median, in median absolute deviations, that are still the surface
+#define FILTER_MAD_LIMIT  4.5f
+
+typedef struct {
+    uint8_t window;         // 0 turns the filter off, 1 judges against the previous ring only
+    uint16_t outlier;       // 0.01 mm off the neighbour median that marks a point suspect, 0 to skip
+    uint16_t ring;          // 0.01 mm off the previous ring that marks a point suspect, 0 to skip
+    uint8_t smooth;         // replace the radius of a good point with the median of its window
+    uint8_t drop;           // leave suspect points out of the stream and the recording
+    uint16_t angle_max;     // turntable steps of a turn
+} filter_config_t;
+
+// One per sensor or zone, points of a ring pass through it in turntable order
+typedef struct {
+    scanner_point_t points[FILTER_WINDOW_MAX];
+    uint8_t count;
+    uint8_t next;           // first point not handed out yet
+    bool ending;            // the ring ended, the last points are handed out with a short window
+    uint8_t current;        // ring of `radius` the points go to, the other one is the previous ring
+    bool previous_valid;
+    uint16_t radius[2][FILTER_RING_BINS];   // 0.01 mm, 0 for no surface or suspect
+} filter_t;
+
+void filter_begin(filter_t* filter);
+bool filter_push(filter_t* filter, const filter_config_t* config, const scanner_point_t* point);
+bool filter_pop(filter_t* filter, const filter_config_t* config, scanner_point_t* point);
+void filter_end_ring(filter_t* filter);
+
+#endif // __3D_SCANNER_FILTER_H__
@@ -0,0 +1,121 @@
+// Path: include/components/kinematics.h
+#ifndef __3D_SCANNER_KINEMATICS_H__
+#define __3D_SCANNER_KINEMATICS_H__
+
+#include <Arduino.h>
+
+// Fixed point unit of the kinematics, 0.01 mm
+#define KINEMATICS_UNIT_NM 10000
+
+// sin(90°) of the table
+#define KINEMATICS_SINE_ONE 32768
+
+namespace kinematics_detail {
+
+constexpr double pi = 3.14159265358979323846;
+
+/**
+ * @brief Taylor series of sin(x), exact to double precision for 0 <= x <= pi / 2
+ */
+constexpr double sine(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; n++) {
+        term = -term * x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr uint32_t gcd(uint32_t a, uint32_t b) {
+    return b == 0 ? a : gcd(b, a % b);
+}
+
+template <uint32_t QUARTER>
+struct sine_table {
+    uint16_t value[QUARTER + 1];
+
+    constexpr sine_table() : value() {
+        for (uint32_t i = 0; i <= QUARTER; i++) {
+            value[i] = (uint16_t)(sine(pi / 2 * i / QUARTER) * KINEMATICS_SINE_ONE + 0.5);
+        }
+    }
+};
+
+} // namespace kinematics_detail
+
+/**
+ * @brief Turntable and Z axis conversions in 0.01 mm, without floating point
+ *
+ * The turntable angle only takes `STEPS_PER_REV * MICRO_STEP` values, so the sine of a quarter turn
+ * is built at compile time and the other quadrants are mirrored from it.
+ *
+ * @tparam STEPS_PER_REV full steps of one turntable turn
+ * @tparam MICRO_STEP microsteps of the driver
+ * @tparam Z_STEP_NM Z axis travel of one step in nm
+ */
+template <uint32_t STEPS_PER_REV, uint32_t MICRO_STEP, uint32_t Z_STEP_NM>
+struct kinematics {
+    static constexpr uint32_t steps = STEPS_PER_REV * MICRO_STEP;
+    static constexpr uint32_t quarter = steps / 4;
+    static_assert(steps % 4 == 0, "A turn must split into four equal quadrants");
+
+    static constexpr kinematics_detail::sine_table<quarter> table{};
+    static_assert(table.value[0] == 0 && table.value[quarter] == KINEMATICS_SINE_ONE, "Sine table out of range");
+
+    static constexpr uint32_t z_gcd = kinematics_detail::gcd(Z_STEP_NM, KINEMATICS_UNIT_NM);
+    static constexpr uint32_t z_num = Z_STEP_NM / z_gcd;
+    static constexpr uint32_t z_den = KINEMATICS_UNIT_NM / z_gcd;
+
+    /**
+     * @brief sin and cos of a turntable position
+     *
+     * @param step `uint32_t`: the turntable position, any number of turns
+     * @param sin `int32_t*`: sin scaled by `KINEMATICS_SINE_ONE`
+     * @param cos `int32_t*`: cos scaled by `KINEMATICS_SINE_ONE`
+     */
+    static inline void sin_cos(uint32_t step, int32_t* sin, int32_t* cos) {
+        step %= steps;
+        uint32_t i = step % quarter;
+        int32_t s = table.value[i];
+        int32_t c = table.value[quarter - i];
+        switch (step / quarter) {
+            case 0: *sin =  s; *cos =  c; break;
+            case 1: *sin =  c; *cos = -s; break;
+            case 2: *sin = -s; *cos = -c; break;
+            default: *sin = -c; *cos =  s; break;
+        }
+    }
+
+    /**
+     * @brief Polar point to x and y, within 0.015 mm of the double precision result up to r = 655 mm
+     *
+     * @param step `uint32_t`: the turntable position
+     * @param r `uint16_t`: the radius in 0.01 mm
+     * @param x `int32_t*`: x in 0.01 mm
+     * @param y `int32_t*`: y in 0.01 mm
+     */
+    static inline void polar_to_xy(uint32_t step, uint16_t r, int32_t* x, int32_t* y) {
+        int32_t sin, cos;
+        sin_cos(step, &sin, &cos);
+        *x = scale(r, cos);
+        *y = scale(r, sin);
+    }
+
+    static inline int32_t scale(uint16_t r, int32_t value) {
+        int32_t product = (int32_t)r * value;
+        return (product + (product < 0 ? -KINEMATICS_SINE_ONE / 2 : KINEMATICS_SINE_ONE / 2)) / KINEMATICS_SINE_ONE;
+    }
+
+    /**
+     * @brief Z axis position to height
+     *
+     * @param z_steps `uint32_t`: the Z axis position
+     * @return `int32_t`: the height in 0.01 mm
+     */
+    static constexpr int32_t z(uint32_t z_steps) {
+        return (int32_t)(((uint64_t)z_steps * z_num + z_den / 2) / z_den);
+    }
+};
+
+#endif // __3D_SCANNER_KINEMATICS_H__
@@ -7,20 +7,30 @@
 #include <Wire.h>
 
 #include <math.h>
-#include <vector>
-#include <unordered_map>
 
 #include "esp_log.h"
 
 #include <ArduinoJson.h>
 #ifdef CONFIG_VL53L1X
 #include <Adafruit_VL53L1X.h>
+#include "components/vl53l1x.h"
 #else
 #include <Adafruit_VL53L0X.h>
 #endif
 
 #include "components/data.h"
 #include "components/server.h"
+#include "components/stepper.h"
+#include "components/planner.h"
+#include "components/points.h"
+#include "components/stream.h"
+#include "components/kinematics.h"
+#include "components/estimator.h"
+#include "components/recorder.h"
+#include "components/catalog.h"
+#include "components/filter.h"
+#include "components/voxel.h"
+#include "components/skip.h"
 
 #define MODULE_TAG_NAME "module"
 
@@ -38,6 +48,7 @@
 #define MOTOR1_DOWN LOW
 
 #define MOTOR1_DEFAULT_STEP_DEGREE 1.8
+#define MOTOR1_DEFAULT_STEPS_PER_REV 200
 #define MOTOR1_DEFAULT_MICRO_STEP  32
 #define MOTOR1_DEFAULT_MICRO_STEP_DEGREE ((MOTOR1_DEFAULT_STEP_DEGREE) / (MOTOR1_DEFAULT_MICRO_STEP))
 
@@ -49,6 +60,7 @@
 #define Z_AXIS_MOTOR_DOWN (MOTOR1_DOWN)
 
 #define Z_AXIS_STEP_MM 0.00125
+#define Z_AXIS_STEP_NM 1250
 #define Z_AXIS_STEP_FLOAT ((Z_AXIS_STEP_MM) * 0.01)
 
 // X and Y axis
@@ -65,6 +77,55 @@
 
 #define LED_PIN 2
 
+// VL53 GPIO1, signals a finished measurement
+#define VL53_INT_PIN 4
+#ifdef CONFIG_VL53L1X
+#define VL53_INT_EDGE RISING
+#else
+#define VL53_INT_EDGE FALLING
+#endif
+
+// No measurement within twice the timing budget plus this margin means the sensor stopped
+#define VL53_TIMEOUT_MARGIN_MS 100
+// Longest sensor wait of the continuous scan, so the end of a ring is seen in time
+#define VL53_WAIT_SLICE_MS 10
+
+#if defined(CONFIG_VL53L1X_MULTI_ZONE) && !defined(CONFIG_VL53L1X)
+#error "CONFIG_VL53L1X_MULTI_ZONE needs CONFIG_VL53L1X"
+#endif
+
+#define VL53_DEFAULT_ADDRESS 0x29
+// With several sensors, sensor n moves to this address plus n while the others are held in reset
+#define VL53_ADDRESS_BASE    0x30
+#define VL53_NO_PIN          0xFF
+// Readings further than this from the center of a sensor are not the object, in mm
+#define VL53_DISTANCE_WINDOW 70
+
+// VL53L1X SPAD array, 16 x 16 with a 27° field of view
+#define VL53_SPAD_ROWS       16
+#define VL53_SPAD_CENTER_COLUMN 8
+#define VL53_SPAD_PITCH_MDEG 1688
+
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+// The rows are cut in bands of full width ROIs, each band gives one point at its own height
+#define VL53_ZONE_COUNT 4
+// 1 if the SPAD rows count up with the Z axis, -1 if the sensor is mounted the other way up
+#define VL53_ZONE_Z_SIGN 1
+#else
+#define VL53_ZONE_COUNT 1
+#endif
+#define VL53_ZONE_ROWS ((VL53_SPAD_ROWS) / (VL53_ZONE_COUNT))
+
+// The zones cycle the ROI of one sensor, so they do not mix with several sensors
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+#define VL53_SENSOR_MAX 1
+#else
+#define VL53_SENSOR_MAX 4
+#endif
+
+// A point filter for each sensor, or for each zone
+#define SCAN_FILTER_COUNT ((VL53_SENSOR_MAX) * (VL53_ZONE_COUNT))
+
 #define SCANNER_COMMAND_STOP  0
 #define SCANNER_COMMAND_HOME  1
 #define SCANNER_COMMAND_NEW   2
@@ -73,14 +134,103 @@
 #define SCANNER_COMMAND_DOWN  5
 #define SCANNER_COMMAND_RIGHT 6
 #define SCANNER_COMMAND_LEFT  7
-
-#define SEND_DATA_TIME_MS 500
+#define SCANNER_COMMAND_RESUME 8
+
+// Queued after the user commands so they apply in order inside the scanner task
+#define SCANNER_COMMAND_SET_NAME 9
+#define SCANNER_COMMAND_SET_MODE 10
+#define SCANNER_COMMAND_SET_ESTIMATOR 11
+#define SCANNER_COMMAND_SET_SKIP 12
+
+#define SCANNER_COMMAND_QUEUE_LENGTH 8
+#define SCANNER_PROJECT_NAME_LENGTH  64
+
+// Arduino loop() and OTA stay on core 1 at priority 1, WiFi and AsyncTCP on core 0
+#define SCANNER_TASK_CORE       1
+#define SCANNER_TASK_PRIORITY   10
+#define SCANNER_TASK_STACK_SIZE 8192
+
+// Readings outside the distance window a point may take before it is a no surface point
+#define SCAN_RANGE_MISS_BUDGET 8
+
+// A checkpoint is written at the end of a ring once this long after the last one, to spare the flash
+#define CHECKPOINT_INTERVAL_MS 60000
+
+#define RESUME_STATE_HOME   0
+#define RESUME_STATE_HOMING 1
+#define RESUME_STATE_RISING 2
+
+#define SCAN_MODE_STEP       0
+#define SCAN_MODE_CONTINUOUS 1
+#define SCAN_MODE_REFINE     2
+#define SCAN_MODE_HELICAL    3
+
+// Coarse to fine scan: the coarse pass takes every `REFINE_COARSE_FACTOR` ring and angle
+#define REFINE_COARSE_FACTOR 4
+// The detail map is one bit per band between two coarse rings and coarse angle segment
+#define REFINE_MAX_BANDS     64
+#define REFINE_MAX_SEGMENTS  256
+// Radius change in 0.01 mm between coarse neighbours that sends a segment to the fine pass
+#define REFINE_EDGE          200
+#define REFINE_NO_SURFACE    0xFFFF
+
+#define REFINE_PASS_COARSE 0
+#define REFINE_PASS_FINE   1
+
+#define SCAN_STATE_IDLE   0
+#define SCAN_STATE_MOVE   1
+#define SCAN_STATE_RANGE  2
+#define SCAN_STATE_Z_MOVE 3
+#define SCAN_STATE_ZONE   4
+
+// Where a VL53 sensor is mounted, kept in NVS. Sensor 0 is the reference, only its XSHUT pin is used
+typedef struct {
+    uint8_t xshut_pin;      // held low until the sensor got its address, `VL53_NO_PIN` if it is always on
+    uint8_t int_pin;        // GPIO1, `VL53_NO_PIN` to poll the sensor
+    uint16_t center;        // distance from the sensor to the turntable axis in mm
+    int16_t angle_steps;    // turntable steps from sensor 0 around the axis
+    int32_t z_steps;        // height above sensor 0 in Z axis steps
+} vl53_sensor_t;
+
+// Samples of the point a sensor is ranging
+typedef struct {
+    estimator_t estimator;
+    unsigned long start_time;
+    unsigned long last_sample_time;
+    uint16_t misses;
+    bool done;
+    double r;               // radius of the finished point, `-1` for no surface
+} scan_range_t;
+
+// Scan progress at a ring boundary, kept in NVS
+typedef struct {
+    char name[SCANNER_PROJECT_NAME_LENGTH];
+    uint32_t z_steps;           // of the next ring
+    uint32_t point_count;
+    uint8_t mode;
+    uint8_t estimator;
+    uint16_t skip_stride;
+} scanner_checkpoint_t;
+
+typedef struct {
+    uint8_t command;
+    uint32_t steps;
+    char name[SCANNER_PROJECT_NAME_LENGTH];
+} scanner_command_t;
 
 void set_project_name(const char* name);
 void module_init();
 void set_command(uint8_t command, uint32_t steps = 0);
+void set_scan_mode(uint8_t mode);
+void set_estimator(uint8_t estimator);
+void set_fast_skip(uint16_t stride);
 void scanner_loop();
 
 uint32_t get_z_axis_counter();
+// The point angle is x_y_steps * MOTOR1_DEFAULT_MICRO_STEP_DEGREE
+typedef kinematics<MOTOR1_DEFAULT_STEPS_PER_REV, MOTOR1_DEFAULT_MICRO_STEP, Z_AXIS_STEP_NM> scanner_kinematics;
+
+void get_x_y(uint32_t x_y_steps, uint16_t r, int32_t* x, int32_t* y);
+int32_t get_z(uint32_t z_steps);
 
 #endif
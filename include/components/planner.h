@@ -0,0 +1,30 @@
+// Path: include/components/planner.h
+#ifndef __3D_SCANNER_PLANNER_H__
+#define __3D_SCANNER_PLANNER_H__
+
+#include <Arduino.h>
+
+#include <math.h>
+
+#include "esp_log.h"
+
+#include "components/stepper.h"
+
+#define PLANNER_TAG_NAME "planner"
+
+// Segments per acceleration ramp, a move is ramp + cruise + ramp
+#define PLANNER_RAMP_SEGMENTS ((STEPPER_MAX_SEGMENTS - 1) / 2)
+
+typedef struct {
+    float start_speed;
+    float max_speed;
+    float acceleration;
+    float jerk;
+} planner_config_t;
+
+void planner_set_config(uint8_t axis, uint32_t start_speed, uint32_t max_speed, uint32_t acceleration, uint32_t jerk);
+uint8_t planner_plan(uint8_t axis, uint32_t steps, stepper_segment_t* segments);
+uint64_t planner_move_time_us(const stepper_segment_t* segments, uint8_t count);
+bool planner_move(uint8_t axis, bool direction, uint32_t steps);
+
+#endif // __3D_SCANNER_PLANNER_H__
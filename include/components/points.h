@@ -0,0 +1,65 @@
+// Path: include/components/points.h
+#ifndef __3D_SCANNER_POINTS_H__
+#define __3D_SCANNER_POINTS_H__
+
+#include <Arduino.h>
+
+#include <atomic>
+
+// Must be a power of two
+#define POINT_BUFFER_SIZE 1024
+
+// The sensor saw nothing inside the distance window at this angle, r is 0
+#define POINT_FLAG_NO_SURFACE 0x01
+// Taken by the fine pass of a refine scan, the level of the point is 1 instead of 0
+#define POINT_FLAG_FINE       0x02
+
+// Taken by a helical scan, z_steps is interpolated
+#define POINT_FLAG_HELIX      0x04
+// Taken by one of several VL53L1X zones, z_steps is where the zone meets the surface
+#define POINT_FLAG_ZONE       0x08
+// The first point of a ring, of a turn for a helical scan
+#define POINT_FLAG_RING       0x10
+// Taken by one of several VL53 sensors, z_steps and x_y_steps include where the sensor is mounted
+#define POINT_FLAG_SENSOR     0x20
+
+// Passed the filter of the scan, r of a good point may be smoothed
+#define POINT_FLAG_FILTERED   0x40
+// The filter found the point off its neighbours or off the previous ring, r is the measured one
+#define POINT_FLAG_SUSPECT    0x80
+
+// The points of a ring do not share z_steps
+#define POINT_FLAG_OWN_Z      ((POINT_FLAG_HELIX) | (POINT_FLAG_ZONE) | (POINT_FLAG_SENSOR))
+
+#define POINT_LEVEL(flags) (((flags) & POINT_FLAG_FINE) ? 1 : 0)
+#define POINT_QUALITY(flags) ((flags) & ((POINT_FLAG_FILTERED) | (POINT_FLAG_SUSPECT)))
+
+typedef struct {
+    uint32_t seq;
+    uint32_t time_ms;
+    uint32_t z_steps;
+    uint16_t x_y_steps;
+    uint16_t r;             // radius in 0.01 mm
+    uint8_t flags;          // POINT_FLAG_*
+} scanner_point_t;
+
+/**
+ * @brief `point` is the first point of a ring that `prev` is not part of
+ *
+ * @param prev `const scanner_point_t*`: the point before
+ * @param point `const scanner_point_t*`: the point
+ */
+inline bool point_new_ring(const scanner_point_t* prev, const scanner_point_t* point) {
+    if (point->flags & POINT_FLAG_RING) return true;
+    return !(point->flags & POINT_FLAG_OWN_Z) && point->z_steps != prev->z_steps;
+}
+
+bool point_buffer_push(const scanner_point_t* point);
+size_t point_buffer_pop(scanner_point_t* points, size_t max_count);
+
+uint32_t point_buffer_count();
+uint32_t point_buffer_high_water_mark();
+uint32_t point_buffer_dropped();
+void point_buffer_reset_stats();
+
+#endif // __3D_SCANNER_POINTS_H__
@@ -0,0 +1,122 @@
+// Path: include/components/recorder.h
+#ifndef __3D_SCANNER_RECORDER_H__
+#define __3D_SCANNER_RECORDER_H__
+
+#include <Arduino.h>
+
+#include <FS.h>
+#include <SD.h>
+#include <SPI.h>
+
+#include "esp_log.h"
+
+#include "components/points.h"
+
+#define RECORDER_TAG_NAME "recorder"
+
+// Writes the SD card from the network core, below the stream task
+#define RECORDER_TASK_CORE       0
+#define RECORDER_TASK_PRIORITY   1
+#define RECORDER_TASK_STACK_SIZE 4096
+
+#define RECORDER_DIR "/scans"
+
+// Multiple of the 512 byte SD block and of the record size, two of them are filled in turn
+#define RECORDER_BUFFER_SIZE 5120
+#define RECORDER_HEADER_SIZE 512
+#define RECORDER_QUEUE_LENGTH 4
+// Header and index reach the card at least this often
+#define RECORDER_SYNC_MS 2000
+// Longest wait of recorder_flush for the card
+#define RECORDER_FLUSH_MS 2000
+
+#define RECORDER_MAGIC   "3DSR"
+// 2 added the surface record count, 3 widened the record z_steps to 32 bits
+#define RECORDER_VERSION 3
+
+#define RECORDER_MESSAGE_START  0
+#define RECORDER_MESSAGE_BUFFER 1
+#define RECORDER_MESSAGE_STOP   2
+#define RECORDER_MESSAGE_RESUME 3
+#define RECORDER_MESSAGE_SYNC   4
+
+// Read and write without truncating, for a resumed recording
+#define RECORDER_FILE_UPDATE "r+"
+
+#define RECORDER_NAME_LENGTH 64
+
+// Little endian, at the start of <name>.bin, the records follow at RECORDER_HEADER_SIZE
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint8_t version;
+    uint8_t record_size;
+    uint16_t header_size;
+    uint32_t records;
+    uint32_t dropped;
+    char name[RECORDER_NAME_LENGTH];
+    uint32_t surface;       // records that are not no surface points
+} recorder_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;
+    uint32_t time_ms;
+    uint32_t z_steps;       // a zone or a sensor offset can reach past z_axis_max
+    uint16_t x_y_steps;
+    uint16_t r;             // radius in 0.01 mm
+    uint8_t flags;          // POINT_FLAG_*
+    uint8_t reserved[3];
+} recorder_record_t;
+
+// The record of versions 1 and 2, still read by the exporter and the catalogue
+typedef struct __attribute__((packed)) {
+    uint32_t seq;
+    uint32_t time_ms;
+    uint16_t z_steps;
+    uint16_t x_y_steps;
+    uint16_t r;
+    uint8_t flags;
+    uint8_t reserved;
+} recorder_record_v2_t;
+
+// One per ring in <name>.idx
+typedef struct __attribute__((packed)) {
+    uint32_t z_steps;
+    uint32_t seq;           // of the first point of the ring
+    uint32_t offset;        // of the first record of the ring in <name>.bin
+} recorder_index_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t buffer;
+    uint16_t length;
+    uint32_t seq;           // the last point kept by a resume
+    char name[RECORDER_NAME_LENGTH];
+} recorder_message_t;
+
+typedef struct {
+    uint32_t records;
+    uint32_t dropped;
+    uint32_t bytes;
+    uint32_t write_us;      // time spent in SD writes
+    uint32_t max_write_us;
+} recorder_stats_t;
+
+void init_recorder();
+bool recorder_ready();
+
+void recorder_start(const char* name);
+void recorder_resume(const char* name, uint32_t seq);
+void recorder_push(const scanner_point_t* point);
+bool recorder_flush();
+void recorder_stop();
+
+recorder_stats_t recorder_get_stats();
+
+fs::FS* recorder_filesystem();
+String recorder_path(const char* name);
+void recorder_file_name(const char* name, char* file_name);
+
+bool recorder_record_size_valid(uint8_t record_size);
+size_t recorder_read_records(File& file, uint8_t record_size, recorder_record_t* records, size_t count);
+
+#endif // __3D_SCANNER_RECORDER_H__
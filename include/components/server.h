@@ -12,12 +12,45 @@
 #include "components/ota.h"
 #include "components/data.h"
 #include "components/module.h"
+#include "components/exporter.h"
+#include "components/catalog.h"
 #include "version.h"
 #include "website.h"
 
 #define SERVER_TAG_NAME "server"
 
+#define WS_MAX_CLIENTS 8
+
+#define WS_CLIENT_READY 0
+#define WS_CLIENT_FULL  1
+#define WS_CLIENT_GONE  2
+
+typedef struct {
+    uint32_t id;
+    uint8_t format;
+    bool replay;            // waits for or gets a replay, live frames skip it
+    uint32_t replay_seq;    // the last point the client has
+} ws_client_t;
+
+// Listing of /api/scans, built one scan at a time while the chunked response is sent
+#define SCANS_LIST_PENDING_SIZE 384
+
+typedef struct {
+    catalog_list_t list;
+    uint8_t part;           // 0 the head, 1 the scans, 2 the tail, 3 done
+    bool first;
+    char pending[SCANS_LIST_PENDING_SIZE];
+    uint16_t pending_length;
+    uint16_t pending_sent;
+} scans_list_t;
+
 void init_server();
 void ws_send_text(const char* message);
+void ws_send_frame(uint8_t format, const uint8_t* data, size_t len);
+bool ws_has_clients(uint8_t format);
+void ws_send_client_frame(uint32_t id, uint8_t format, const uint8_t* data, size_t len);
+uint8_t ws_client_state(uint32_t id);
+bool ws_next_replay(uint32_t* id, uint8_t* format, uint32_t* seq);
+void ws_end_replay(uint32_t id);
 
 #endif // __3D_SCANNER_SERVER_H__
\ No newline at end of file
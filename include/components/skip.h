@@ -0,0 +1,26 @@
+// Path: include/components/skip.h
+#ifndef __3D_SCANNER_SKIP_H__
+#define __3D_SCANNER_SKIP_H__
+
+#include <Arduino.h>
+
+#include "esp_log.h"
+
+#define SKIP_TAG_NAME "skip"
+
+// Empty points in a row before the fast skip takes longer strides
+#define SKIP_AFTER 3
+
+// Fast skip of a ring of the step scan, the turntable position is in points or steps as long as it is the same
+typedef struct {
+    uint16_t stride;        // points of a stride, below 2 turns the skip off
+    uint16_t empty_run;     // empty points in a row
+    bool active;            // the next move is a stride
+    uint32_t hold;          // where a step back found the surface, no stride until past it
+} skip_t;
+
+void skip_begin(skip_t* skip, uint16_t stride);
+uint16_t skip_check(skip_t* skip, uint32_t position, bool surface);
+uint16_t skip_points(const skip_t* skip);
+
+#endif // __3D_SCANNER_SKIP_H__
@@ -0,0 +1,67 @@
+// Path: include/components/stepper.h
+#ifndef __3D_SCANNER_STEPPER_H__
+#define __3D_SCANNER_STEPPER_H__
+
+#include <Arduino.h>
+
+#include "esp_log.h"
+#include "driver/timer.h"
+
+#define STEPPER_TAG_NAME "stepper"
+
+#define STEPPER_AXIS_Z     0
+#define STEPPER_AXIS_X_Y   1
+#define STEPPER_AXIS_COUNT 2
+
+// 80 MHz APB clock / 80 = 1 tick per microsecond
+#define STEPPER_TIMER_DIVIDER 80
+#define STEPPER_MIN_HALF_PERIOD_US 2
+
+#define STEPPER_NO_HOME_PIN 0xFF
+
+#define STEPPER_MAX_SEGMENTS 32
+
+typedef struct {
+    uint32_t steps;
+    uint32_t half_period_us;
+} stepper_segment_t;
+
+typedef struct {
+    uint8_t step_pin;
+    uint8_t dir_pin;
+    uint8_t home_pin;
+    uint8_t home_level;
+
+    timer_group_t timer_group;
+    timer_idx_t timer_idx;
+
+    int32_t min_position;
+    int32_t max_position;
+
+    stepper_segment_t segments[STEPPER_MAX_SEGMENTS];
+    uint8_t segment_count;
+
+    volatile uint8_t segment_index;
+    volatile int32_t position;
+    volatile uint32_t remaining;
+    volatile uint32_t half_period_us;
+    volatile bool direction;
+    volatile bool level;
+    volatile bool busy;
+} stepper_axis_t;
+
+void stepper_init(uint8_t axis, uint8_t step_pin, uint8_t dir_pin);
+void stepper_set_limit(uint8_t axis, int32_t min_position, int32_t max_position, uint8_t home_pin = STEPPER_NO_HOME_PIN, uint8_t home_level = LOW);
+
+bool stepper_move(uint8_t axis, bool direction, uint32_t steps, uint32_t half_period_us);
+bool stepper_move_segments(uint8_t axis, bool direction, const stepper_segment_t* segments, uint8_t count);
+void stepper_stop(uint8_t axis);
+void stepper_wait(uint8_t axis);
+bool stepper_is_busy(uint8_t axis);
+
+int32_t stepper_get_position(uint8_t axis);
+void stepper_set_position(uint8_t axis, int32_t position);
+
+bool stepper_next_edge(stepper_axis_t* axis, bool home_active);
+
+#endif // __3D_SCANNER_STEPPER_H__
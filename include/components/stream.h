@@ -0,0 +1,121 @@
+// Path: include/components/stream.h
+#ifndef __3D_SCANNER_STREAM_H__
+#define __3D_SCANNER_STREAM_H__
+
+#include <Arduino.h>
+
+#include <FS.h>
+
+#include "esp_log.h"
+
+#include "components/points.h"
+#include "components/codec.h"
+#include "components/recorder.h"
+
+#define STREAM_TAG_NAME "stream"
+
+// Sends from the network core, below AsyncTCP
+#define STREAM_TASK_CORE       0
+#define STREAM_TASK_PRIORITY   1
+#define STREAM_TASK_STACK_SIZE 6144
+
+#define STREAM_IDLE_WAIT_MS     100
+#define STREAM_BATCH_MAX_POINTS 128
+
+// Size estimate of a JSON frame, used by the byte limit of a batch
+#define STREAM_JSON_HEADER_BYTES 160
+#define STREAM_JSON_POINT_BYTES   28
+
+// Task notification bits
+#define STREAM_NOTIFY_POINTS 0x01
+#define STREAM_NOTIFY_FLUSH  0x02
+#define STREAM_NOTIFY_REPLAY 0x04
+
+// Points sent last, kept for clients that reconnect. Older points are read back from the SD recording
+#define STREAM_REPLAY_POINTS 1024
+// Replay batches sent before the live points get their turn again
+#define STREAM_REPLAY_SLICE 4
+// Wait while the send queue of the replayed client is full
+#define STREAM_REPLAY_WAIT_MS 5
+// Records read from the SD recording at once, as many as fit in one SD block
+#define STREAM_REPLAY_RECORDS (512 / sizeof(recorder_record_t))
+
+// Per WebSocket client, picked with {"format": "json" | "binary" | "polar" | "ring" | "ring_rle"}
+#define STREAM_FORMAT_JSON     0
+#define STREAM_FORMAT_XYZ      1
+#define STREAM_FORMAT_POLAR    2
+#define STREAM_FORMAT_RING     3
+#define STREAM_FORMAT_RING_RLE 4
+#define STREAM_FORMAT_COUNT    5
+
+#define STREAM_FRAME_XYZ   1
+#define STREAM_FRAME_POLAR 2
+// Points with their own height, helical scans and several zones, see `stream_frame_dz_point_t`
+#define STREAM_FRAME_XYZ_DZ   3
+#define STREAM_FRAME_POLAR_DZ 4
+// Radius changes as zig-zag varints, see `codec_ring_add`, the angle follows a fixed step
+#define STREAM_FRAME_RING     5
+#define STREAM_FRAME_RING_DZ  6
+#define STREAM_FRAME_RING_RLE 7
+
+// Quality of all points of a frame, see `POINT_FLAG_FILTERED` and `POINT_FLAG_SUSPECT`
+#define STREAM_LEVEL_FILTERED 0x80
+#define STREAM_LEVEL_SUSPECT  0x40
+
+// Little endian, followed by `count` points of 4 bytes:
+// XYZ:   int16 x, int16 y in 0.01 mm, z comes from the header
+// POLAR: uint16 x_y_steps, uint16 r in 0.01 mm
+#define STREAM_XYZ_NO_SURFACE   INT16_MIN     // x and y of a no surface point
+#define STREAM_POLAR_NO_SURFACE 0xFFFF        // r of a no surface point
+typedef struct __attribute__((packed)) {
+    uint8_t type;
+    uint8_t level;          // 0, or 1 for the fine pass of a refine scan, with the `STREAM_LEVEL_*` bits
+    uint16_t count;
+    uint32_t seq;           // of the first point, the others follow one by one
+    uint32_t z_steps;       // shared by all points of the frame
+    uint32_t time_ms;       // of the first point
+} stream_frame_header_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t a;
+    int16_t b;
+} stream_frame_point_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t a;
+    int16_t b;
+    int16_t dz;             // z_steps above the z_steps of the header
+} stream_frame_dz_point_t;
+
+// The client a replay is sent to, live frames skip it until the replay caught up
+typedef struct {
+    bool active;
+    uint32_t client;
+    uint8_t format;
+    uint32_t seq;           // the next point to send
+    uint32_t last;          // the last point sent
+    uint32_t lost;          // points neither kept nor recorded
+    File file;              // the SD recording, closed once it is read up to the kept points
+    uint32_t record;        // the next record of `file`
+    uint32_t records;
+} stream_replay_t;
+
+// A batch is sent as soon as one limit is reached
+typedef struct {
+    uint16_t batch_points;
+    uint16_t batch_bytes;
+    uint16_t batch_time;        // ms
+    uint8_t batch_ring;         // also send at the end of every ring
+    uint16_t status_time;       // ms between status frames while stopped
+} stream_policy_t;
+
+void init_stream();
+void stream_set_name(const char* name);
+void stream_notify();
+void stream_flush();
+void stream_replay_notify();
+void stream_set_policy(const stream_policy_t* policy);
+stream_policy_t stream_get_policy();
+uint8_t stream_format_from_name(const char* name);
+
+#endif // __3D_SCANNER_STREAM_H__
@@ -0,0 +1,44 @@
+// Path: include/components/vl53l1x.h
+#ifndef __3D_SCANNER_VL53L1X_H__
+#define __3D_SCANNER_VL53L1X_H__
+
+#include <Arduino.h>
+
+#include <Wire.h>
+
+#include "esp_log.h"
+
+#define VL53L1X_TAG_NAME "vl53l1x"
+
+// Fast mode plus, the sensor takes up to 1 MHz, long wires or weak pull ups fall back to fast mode
+#define VL53L1X_I2C_CLOCK_FAST_PLUS 1000000
+#define VL53L1X_I2C_CLOCK_FAST       400000
+
+// Registers, 16 bit index, big endian
+#define VL53L1X_GPIO_HV_MUX__CTRL        0x0030
+#define VL53L1X_GPIO__TIO_HV_STATUS      0x0031
+#define VL53L1X_SYSTEM__INTERRUPT_CLEAR  0x0086
+#define VL53L1X_RESULT__RANGE_STATUS     0x0089
+
+// From RESULT__RANGE_STATUS up to the signal rate of the final range
+#define VL53L1X_RESULT_LENGTH 17
+
+#define VL53L1X_STATUS_VALID 0
+
+typedef struct {
+    uint8_t status;         // `VL53L1X_STATUS_VALID`, or the error of the measurement
+    uint16_t distance;      // mm
+    uint16_t signal_rate;   // kcps of all the SPADs together, the register times 8
+    uint16_t ambient_rate;  // kcps
+    uint8_t spads;          // SPADs enabled for the measurement
+} vl53l1x_result_t;
+
+bool vl53l1x_read_polarity(TwoWire* wire, uint8_t address, uint8_t* polarity);
+bool vl53l1x_data_ready(TwoWire* wire, uint8_t address, uint8_t polarity);
+bool vl53l1x_read_result(TwoWire* wire, uint8_t address, vl53l1x_result_t* result);
+bool vl53l1x_clear_interrupt(TwoWire* wire, uint8_t address);
+bool vl53l1x_read_sample(TwoWire* wire, uint8_t address, uint8_t polarity, bool interrupt, vl53l1x_result_t* result);
+void vl53l1x_decode_result(const uint8_t* raw, vl53l1x_result_t* result);
+uint32_t vl53l1x_transactions();
+
+#endif // __3D_SCANNER_VL53L1X_H__
@@ -0,0 +1,47 @@
+// Path: include/components/voxel.h
+#ifndef __3D_SCANNER_VOXEL_H__
+#define __3D_SCANNER_VOXEL_H__
+
+#include <Arduino.h>
+
+#include "esp_log.h"
+
+#include "components/points.h"
+
+#define VOXEL_TAG_NAME "voxel"
+
+// Voxels waiting for their Z band to end, must be a power of two
+#define VOXEL_CAPACITY 1024
+
+typedef struct {
+    uint16_t angle_bins;    // turntable bins of a turn
+    uint16_t angle_max;     // turntable steps of a turn
+    uint32_t z_size;        // Z axis steps of a band
+} voxel_config_t;
+
+typedef struct {
+    uint32_t z_bin;
+    uint16_t angle_bin;
+    uint16_t count;         // 0 for a free slot
+    uint32_t time_ms;       // of the first point
+    uint32_t angle_sum;     // turntable steps from the start of the bin
+    uint32_t r_sum;         // 0.01 mm
+    uint8_t flags;
+} voxel_entry_t;
+
+typedef struct {
+    voxel_entry_t entries[VOXEL_CAPACITY];
+    uint16_t count;
+    // Where `voxel_pop` goes on, the band is only valid while `band_valid` is set
+    bool band_valid;
+    bool band_start;
+    uint32_t band;
+    uint16_t angle_bin;
+} voxel_t;
+
+void voxel_begin(voxel_t* voxel);
+bool voxel_add(voxel_t* voxel, const voxel_config_t* config, const scanner_point_t* point);
+bool voxel_pop(voxel_t* voxel, const voxel_config_t* config, uint32_t z_floor, scanner_point_t* point, bool* band_start);
+uint16_t voxel_count(const voxel_t* voxel);
+
+#endif // __3D_SCANNER_VOXEL_H__
@@ -8,5 +8,18 @@
 #include "components/network.h"
 #include "components/server.h"
 #include "components/module.h"
+#include "components/stepper.h"
+#include "components/planner.h"
+#include "components/points.h"
+#include "components/stream.h"
+#include "components/kinematics.h"
+#include "components/estimator.h"
+#include "components/recorder.h"
+#include "components/vl53l1x.h"
+#include "components/filter.h"
+#include "components/voxel.h"
+#include "components/codec.h"
+#include "components/exporter.h"
+#include "components/catalog.h"
 
 #endif // __3D_SCANNER_HEADER_H__
\ No newline at end of file
@@ -0,0 +1,420 @@
+// Path: src/components/catalog.cpp
+#include "components/catalog.h"    // include/components/catalog.h
+
+#include "components/module.h"
+
+const char* CATALOG_TAG = CATALOG_TAG_NAME;
+
+// The recorder task writes slots while the web server lists and removes them
+SemaphoreHandle_t catalog_mutex = NULL;
+File catalog_file;
+uint16_t catalog_count = 0;
+
+bool catalog_create();
+void catalog_rebuild();
+void catalog_recover();
+uint16_t catalog_home(const char* name);
+bool catalog_find(const char* name, uint16_t* slot, catalog_entry_t* entry);
+bool catalog_read_slots(uint16_t slot, catalog_entry_t* entries, uint16_t count);
+bool catalog_write_slot(uint16_t slot, const catalog_entry_t* entry);
+bool catalog_store(const catalog_entry_t* entry);
+bool catalog_lock();
+void catalog_unlock();
+
+/**
+ * @brief Open the catalogue on the SD card, build it from the recordings if there is none, called by `init_recorder`
+ *
+ * @return `bool`: `false` if the catalogue can not be used, recording goes on without it
+ */
+bool init_catalog() {
+    fs::FS* fs = recorder_filesystem();
+    if (fs == NULL) return false;
+
+    catalog_mutex = xSemaphoreCreateMutex();
+    if (catalog_mutex == NULL) {
+        ESP_LOGE(CATALOG_TAG, "Failed to create the catalogue mutex");
+        return false;
+    }
+
+    bool rebuild = false;
+    if (fs->exists(CATALOG_PATH)) {
+        catalog_file = fs->open(CATALOG_PATH, RECORDER_FILE_UPDATE);
+        if (catalog_file && catalog_file.size() != CATALOG_SLOTS * sizeof(catalog_entry_t)) {
+            ESP_LOGW(CATALOG_TAG, "%s has the wrong size, rebuild it", CATALOG_PATH);
+            catalog_file.close();
+            rebuild = true;
+        }
+    } else {
+        rebuild = true;
+    }
+    if (rebuild && !catalog_create()) return false;
+    if (!catalog_file) {
+        ESP_LOGE(CATALOG_TAG, "Failed to open %s", CATALOG_PATH);
+        return false;
+    }
+
+    if (rebuild) catalog_rebuild();
+    catalog_recover();
+    ESP_LOGI(CATALOG_TAG, "Catalogue has %u scans", catalog_count);
+    return true;
+}
+
+/**
+ * @brief Start the entry of a new recording with the module settings it is scanned with
+ *
+ * @param entry `catalog_entry_t*`: the entry
+ * @param name `const char*`: the project name
+ */
+void catalog_begin(catalog_entry_t* entry, const char* name) {
+    memset(entry, 0, sizeof(catalog_entry_t));
+    strncpy(entry->name, name, RECORDER_NAME_LENGTH - 1);
+    entry->state = CATALOG_STATE_RECORDING;
+    entry->data_offset = RECORDER_HEADER_SIZE;
+    entry->data_end = RECORDER_HEADER_SIZE;
+    catalog_clear_records(entry);
+
+    uint16_t z_axis_max, z_axis_start_step, z_axis_delay_time, z_axis_one_time_step;
+    uint16_t x_y_axis_max, x_y_axis_check_times, x_y_axis_step_delay_time, x_y_axis_one_time_step;
+    uint16_t vl53l1x_center, vl53l1x_timeing_budget;
+    get_module(&z_axis_max, &z_axis_start_step, &z_axis_delay_time, &z_axis_one_time_step,
+               &x_y_axis_max, &x_y_axis_check_times, &x_y_axis_step_delay_time, &x_y_axis_one_time_step,
+               &vl53l1x_center, &vl53l1x_timeing_budget);
+    entry->z_axis_max = z_axis_max;
+    entry->z_axis_start_step = z_axis_start_step;
+    entry->z_axis_delay_time = z_axis_delay_time;
+    entry->z_axis_one_time_step = z_axis_one_time_step;
+    entry->x_y_axis_max = x_y_axis_max;
+    entry->x_y_axis_check_times = x_y_axis_check_times;
+    entry->x_y_axis_step_delay_time = x_y_axis_step_delay_time;
+    entry->x_y_axis_one_time_step = x_y_axis_one_time_step;
+    entry->vl53l1x_center = vl53l1x_center;
+    entry->vl53l1x_timeing_budget = vl53l1x_timeing_budget;
+}
+
+/**
+ * @brief Count records and grow the bounding box by their surface points
+ *
+ * @param entry `catalog_entry_t*`: the entry
+ * @param records `const recorder_record_t*`: the records
+ * @param count `size_t`: the number of records
+ */
+void catalog_add_records(catalog_entry_t* entry, const recorder_record_t* records, size_t count) {
+    entry->records += count;
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].flags & POINT_FLAG_NO_SURFACE) continue;
+        entry->surface++;
+
+        int32_t x = 0, y = 0;
+        get_x_y(records[i].x_y_steps, records[i].r, &x, &y);
+        int32_t z = get_z(records[i].z_steps);
+        if (x < entry->min_x) entry->min_x = x;
+        if (y < entry->min_y) entry->min_y = y;
+        if (z < entry->min_z) entry->min_z = z;
+        if (x > entry->max_x) entry->max_x = x;
+        if (y > entry->max_y) entry->max_y = y;
+        if (z > entry->max_z) entry->max_z = z;
+    }
+}
+
+void catalog_clear_records(catalog_entry_t* entry) {
+    entry->records = 0;
+    entry->surface = 0;
+    entry->min_x = entry->min_y = entry->min_z = INT32_MAX;
+    entry->max_x = entry->max_y = entry->max_z = INT32_MIN;
+}
+
+/**
+ * @brief Add an entry or replace the entry of the same file name
+ *
+ * @param entry `const catalog_entry_t*`: the entry
+ * @return `bool`: `false` if the catalogue is full or can not be written
+ */
+bool catalog_put(const catalog_entry_t* entry) {
+    if (!catalog_lock()) return false;
+    bool stored = catalog_store(entry);
+    catalog_file.flush();
+    catalog_unlock();
+    return stored;
+}
+
+/**
+ * @brief Look up a scan, usually a single slot read
+ *
+ * @param name `const char*`: the project name
+ * @param entry `catalog_entry_t*`: the entry found
+ * @return `bool`: `false` if there is no such scan
+ */
+bool catalog_get(const char* name, catalog_entry_t* entry) {
+    if (!catalog_lock()) return false;
+    uint16_t slot;
+    bool found = catalog_find(name, &slot, entry);
+    catalog_unlock();
+    return found;
+}
+
+/**
+ * @brief Delete a scan, its recording files and its entry
+ *
+ * @param name `const char*`: the project name
+ * @return `uint8_t`: `CATALOG_REMOVE_*`, a scan still recording is not removed
+ */
+uint8_t catalog_remove(const char* name) {
+    if (!catalog_lock()) return CATALOG_REMOVE_ERROR;
+
+    uint16_t slot;
+    catalog_entry_t entry;
+    if (!catalog_find(name, &slot, &entry)) {
+        catalog_unlock();
+        return CATALOG_REMOVE_NOT_FOUND;
+    }
+    if (entry.state == CATALOG_STATE_RECORDING) {
+        catalog_unlock();
+        return CATALOG_REMOVE_BUSY;
+    }
+
+    fs::FS* fs = recorder_filesystem();
+    String path = recorder_path(entry.name);
+    if (fs->exists((path + ".bin").c_str())) fs->remove((path + ".bin").c_str());
+    if (fs->exists((path + ".idx").c_str())) fs->remove((path + ".idx").c_str());
+
+    // Shift the probe chain after the slot back, so no tombstones are left
+    uint16_t i = slot;
+    uint16_t j = slot;
+    bool written = true;
+    for (;;) {
+        j = (j + 1) & (CATALOG_SLOTS - 1);
+        if (!catalog_read_slots(j, &entry, 1) || entry.state == CATALOG_STATE_EMPTY) break;
+        uint16_t home = catalog_home(entry.name);
+        // An entry whose home lies cyclically in (i, j] is still reachable
+        bool reachable = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (reachable) continue;
+        written &= catalog_write_slot(i, &entry);
+        i = j;
+    }
+    memset(&entry, 0, sizeof(entry));
+    written &= catalog_write_slot(i, &entry);
+    catalog_file.flush();
+    catalog_count--;
+    catalog_unlock();
+
+    ESP_LOGI(CATALOG_TAG, "Removed %s", path.c_str());
+    return written ? CATALOG_REMOVE_OK : CATALOG_REMOVE_ERROR;
+}
+
+void catalog_list_begin(catalog_list_t* list) {
+    list->slot = 0;
+    list->block_first = 0;
+    list->block_count = 0;
+}
+
+/**
+ * @brief Hand out the next scan of a listing, the slots are read a few at a time
+ *
+ * @param list `catalog_list_t*`: the listing
+ * @param entry `catalog_entry_t*`: the next scan
+ * @return `bool`: `false` after the last scan
+ */
+bool catalog_list_next(catalog_list_t* list, catalog_entry_t* entry) {
+    while (list->slot < CATALOG_SLOTS) {
+        if (list->slot >= list->block_first + list->block_count) {
+            uint16_t count = min(CATALOG_READ_SLOTS, CATALOG_SLOTS - list->slot);
+            if (!catalog_lock()) return false;
+            bool read = catalog_read_slots(list->slot, list->block, count);
+            catalog_unlock();
+            if (!read) return false;
+            list->block_first = list->slot;
+            list->block_count = count;
+        }
+        const catalog_entry_t* slot = &list->block[list->slot - list->block_first];
+        list->slot++;
+        if (slot->state == CATALOG_STATE_EMPTY) continue;
+        *entry = *slot;
+        return true;
+    }
+    return false;
+}
+
+const char* catalog_state_name(uint8_t state) {
+    if (state == CATALOG_STATE_RECORDING) return "recording";
+    if (state == CATALOG_STATE_INTERRUPTED) return "interrupted";
+    return "done";
+}
+
+/**
+ * @brief Write a catalogue of empty slots
+ */
+bool catalog_create() {
+    catalog_file = recorder_filesystem()->open(CATALOG_PATH, FILE_WRITE);
+    if (!catalog_file) {
+        ESP_LOGE(CATALOG_TAG, "Failed to create %s", CATALOG_PATH);
+        return false;
+    }
+    uint8_t block[512] = { 0 };
+    for (size_t length = CATALOG_SLOTS * sizeof(catalog_entry_t); length > 0; ) {
+        size_t written = catalog_file.write(block, min(sizeof(block), length));
+        if (written == 0) {
+            ESP_LOGE(CATALOG_TAG, "Failed to write %s", CATALOG_PATH);
+            catalog_file.close();
+            return false;
+        }
+        length -= written;
+    }
+    catalog_file.close();
+
+    // Reopen for slot updates, FILE_WRITE only appends
+    catalog_file = recorder_filesystem()->open(CATALOG_PATH, RECORDER_FILE_UPDATE);
+    catalog_count = 0;
+    return (bool)catalog_file;
+}
+
+/**
+ * @brief Add the recordings already on the card, their module settings are not known and stay `0`
+ */
+void catalog_rebuild() {
+    fs::FS* fs = recorder_filesystem();
+    File dir = fs->open(RECORDER_DIR);
+    if (!dir || !dir.isDirectory()) return;
+
+    recorder_record_t records[RECORDER_HEADER_SIZE / sizeof(recorder_record_t)];
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        const char* file_name = strrchr(file.name(), '/');
+        file_name = file_name != NULL ? file_name + 1 : file.name();
+        size_t length = strlen(file_name);
+        recorder_header_t header;
+        if (file.isDirectory() || length < 4 || strcmp(file_name + length - 4, ".bin") != 0 ||
+            file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, RECORDER_MAGIC, sizeof(header.magic)) != 0 ||
+            !recorder_record_size_valid(header.record_size) || header.header_size != RECORDER_HEADER_SIZE) {
+            file.close();
+            continue;
+        }
+
+        catalog_entry_t entry;
+        memset(&entry, 0, sizeof(entry));
+        if (header.name[0] != '\0') {
+            strncpy(entry.name, header.name, RECORDER_NAME_LENGTH - 1);
+        } else {
+            strncpy(entry.name, file_name, min(length - 4, (size_t)RECORDER_NAME_LENGTH - 1));
+        }
+        entry.state = CATALOG_STATE_DONE;
+        entry.data_offset = RECORDER_HEADER_SIZE;
+        entry.data_end = RECORDER_HEADER_SIZE + header.records * header.record_size;
+        catalog_clear_records(&entry);
+
+        // One pass for the bounding box
+        file.seek(RECORDER_HEADER_SIZE);
+        for (uint32_t left = header.records; left > 0; ) {
+            size_t count = min(left, (uint32_t)(sizeof(records) / sizeof(recorder_record_t)));
+            size_t read = recorder_read_records(file, header.record_size, records, count);
+            catalog_add_records(&entry, records, read);
+            if (read < count) break;
+            left -= read;
+        }
+        file.close();
+
+        String index = recorder_path(entry.name) + ".idx";
+        if (fs->exists(index.c_str())) {
+            File index_file = fs->open(index.c_str(), FILE_READ);
+            entry.index_end = index_file.size();
+            index_file.close();
+        }
+
+        if (!catalog_store(&entry)) break;
+        ESP_LOGI(CATALOG_TAG, "Found %s, records: %u", entry.name, entry.records);
+    }
+    dir.close();
+    catalog_file.flush();
+}
+
+/**
+ * @brief Count the scans and mark the ones cut by a restart as interrupted
+ */
+void catalog_recover() {
+    catalog_entry_t block[CATALOG_READ_SLOTS];
+    catalog_count = 0;
+    for (uint16_t first = 0; first < CATALOG_SLOTS; first += CATALOG_READ_SLOTS) {
+        if (!catalog_read_slots(first, block, CATALOG_READ_SLOTS)) return;
+        for (uint16_t i = 0; i < CATALOG_READ_SLOTS; i++) {
+            if (block[i].state == CATALOG_STATE_EMPTY) continue;
+            catalog_count++;
+            if (block[i].state != CATALOG_STATE_RECORDING) continue;
+            block[i].state = CATALOG_STATE_INTERRUPTED;
+            catalog_write_slot(first + i, &block[i]);
+        }
+    }
+    catalog_file.flush();
+}
+
+/**
+ * @brief Home slot of a scan, FNV-1a of its file name, so names that share a file share a slot
+ */
+uint16_t catalog_home(const char* name) {
+    char file_name[RECORDER_NAME_LENGTH];
+    recorder_file_name(name, file_name);
+    uint32_t hash = 2166136261u;
+    for (const char* c = file_name; *c != '\0'; c++) hash = (hash ^ (uint8_t)*c) * 16777619u;
+    return hash & (CATALOG_SLOTS - 1);
+}
+
+/**
+ * @brief Slot of a scan, linear probing from its home slot, called with the lock held
+ *
+ * @param name `const char*`: the project name
+ * @param slot `uint16_t*`: the slot of the scan, or the empty slot that ends its probe chain, `CATALOG_SLOTS` if the card can not be read
+ * @param entry `catalog_entry_t*`: the entry in the slot
+ * @return `bool`: `true` if the scan was found
+ */
+bool catalog_find(const char* name, uint16_t* slot, catalog_entry_t* entry) {
+    char file_name[RECORDER_NAME_LENGTH];
+    char entry_file_name[RECORDER_NAME_LENGTH];
+    recorder_file_name(name, file_name);
+
+    *slot = CATALOG_SLOTS;
+    uint16_t i = catalog_home(name);
+    for (uint16_t probes = 0; probes < CATALOG_SLOTS; probes++) {
+        if (!catalog_read_slots(i, entry, 1)) return false;
+        *slot = i;
+        if (entry->state == CATALOG_STATE_EMPTY) return false;
+        recorder_file_name(entry->name, entry_file_name);
+        if (strcmp(file_name, entry_file_name) == 0) return true;
+        i = (i + 1) & (CATALOG_SLOTS - 1);
+    }
+    return false;
+}
+
+bool catalog_read_slots(uint16_t slot, catalog_entry_t* entries, uint16_t count) {
+    if (!catalog_file || !catalog_file.seek(slot * sizeof(catalog_entry_t))) return false;
+    return catalog_file.read((uint8_t*)entries, count * sizeof(catalog_entry_t)) == count * sizeof(catalog_entry_t);
+}
+
+bool catalog_write_slot(uint16_t slot, const catalog_entry_t* entry) {
+    if (!catalog_file || !catalog_file.seek(slot * sizeof(catalog_entry_t))) return false;
+    return catalog_file.write((const uint8_t*)entry, sizeof(catalog_entry_t)) == sizeof(catalog_entry_t);
+}
+
+/**
+ * @brief `catalog_put` with the lock held
+ */
+bool catalog_store(const catalog_entry_t* entry) {
+    uint16_t slot;
+    catalog_entry_t found;
+    if (!catalog_find(entry->name, &slot, &found)) {
+        if (slot >= CATALOG_SLOTS) return false;
+        // One slot stays free so every probe ends
+        if (catalog_count >= CATALOG_SLOTS - 1) {
+            ESP_LOGW(CATALOG_TAG, "Catalogue full, %s is not listed", entry->name);
+            return false;
+        }
+        catalog_count++;
+    }
+    return catalog_write_slot(slot, entry);
+}
+
+bool catalog_lock() {
+    if (catalog_mutex == NULL || !catalog_file) return false;
+    return xSemaphoreTake(catalog_mutex, pdMS_TO_TICKS(CATALOG_LOCK_MS)) == pdTRUE;
+}
+
+void catalog_unlock() {
+    xSemaphoreGive(catalog_mutex);
+}
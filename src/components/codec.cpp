@@ -0,0 +1,173 @@
+// Path: src/components/codec.cpp
+#include "components/codec.h"    // include/components/codec.h
+
+void codec_ring_flush_run(codec_ring_encoder_t* encoder);
+
+/**
+ * @brief Start a ring body, the points follow one by one as they are taken
+ *
+ * @param encoder `codec_ring_encoder_t*`: the encoder
+ * @param buffer `uint8_t*`: the body
+ * @param size `size_t`: the room of the body, at least `CODEC_RING_HEADER_BYTES`
+ * @param rle `bool`: write a run of unchanged radii as one symbol
+ * @param dz `bool`: every point carries its own height
+ */
+void codec_ring_begin(codec_ring_encoder_t* encoder, uint8_t* buffer, size_t size, bool rle, bool dz) {
+    encoder->buffer = buffer;
+    encoder->size = size;
+    encoder->length = CODEC_RING_HEADER_BYTES;
+    encoder->count = 0;
+    encoder->last_angle = 0;
+    encoder->step = 0;
+    encoder->last_r = 0;
+    encoder->zero_run = 0;
+    encoder->rle = rle && !dz;
+    encoder->dz = dz;
+}
+
+/**
+ * @brief Add the next point of the ring
+ *
+ * The angle is not written: the second point sets the step, every later one has to follow it.
+ * The radius is written as the zig-zag varint of its change, with `rle` a symbol is `change << 1`
+ * or `run << 1 | 1` for a run of unchanged radii.
+ *
+ * @param encoder `codec_ring_encoder_t*`: the encoder
+ * @param angle `uint16_t`: turntable steps
+ * @param r `uint16_t`: 0.01 mm, `0` for no surface
+ * @param dz `int16_t`: Z axis steps above the frame, only written with `dz`
+ * @return `bool`: `false` if the point is off the step or the body is full, it then starts the next body
+ */
+bool codec_ring_add(codec_ring_encoder_t* encoder, uint16_t angle, uint16_t r, int16_t dz) {
+    if (encoder->length + CODEC_RING_POINT_BYTES > encoder->size) return false;
+    if (encoder->count == 1) {
+        if (angle <= encoder->last_angle) return false;
+        encoder->step = angle - encoder->last_angle;
+    } else if (encoder->count > 1 && angle != (uint16_t)(encoder->last_angle + encoder->step)) {
+        return false;
+    }
+
+    int32_t delta = (int32_t)r - encoder->last_r;
+    if (encoder->rle) {
+        if (delta == 0 && encoder->zero_run < UINT16_MAX) {
+            encoder->zero_run++;
+        } else {
+            codec_ring_flush_run(encoder);
+            encoder->length += codec_put_varint(encoder->buffer + encoder->length, codec_zigzag(delta) << 1);
+        }
+    } else {
+        encoder->length += codec_put_varint(encoder->buffer + encoder->length, codec_zigzag(delta));
+    }
+    if (encoder->dz) encoder->length += codec_put_varint(encoder->buffer + encoder->length, codec_zigzag(dz));
+
+    if (encoder->count == 0) {
+        encoder->buffer[0] = angle & 0xFF;
+        encoder->buffer[1] = angle >> 8;
+    }
+    encoder->last_angle = angle;
+    encoder->last_r = r;
+    encoder->count++;
+    return true;
+}
+
+/**
+ * @brief Close the body
+ *
+ * @param encoder `codec_ring_encoder_t*`: the encoder
+ * @return `size_t`: the size of the body in bytes
+ */
+size_t codec_ring_end(codec_ring_encoder_t* encoder) {
+    codec_ring_flush_run(encoder);
+    encoder->buffer[2] = encoder->step & 0xFF;
+    encoder->buffer[3] = encoder->step >> 8;
+    return encoder->length;
+}
+
+void codec_ring_flush_run(codec_ring_encoder_t* encoder) {
+    if (encoder->zero_run == 0) return;
+    if (encoder->zero_run == 1) {
+        encoder->length += codec_put_varint(encoder->buffer + encoder->length, 0);
+    } else {
+        encoder->length += codec_put_varint(encoder->buffer + encoder->length, ((uint32_t)encoder->zero_run << 1) | 1);
+    }
+    encoder->zero_run = 0;
+}
+
+/**
+ * @brief Decode a ring body
+ *
+ * @param data `const uint8_t*`: the body
+ * @param length `size_t`: the size of the body
+ * @param count `uint16_t`: the points of the frame
+ * @param rle `bool`: the body has runs
+ * @param dz `bool`: the body has a dz for every point
+ * @param angles `uint16_t*`: `count` turntable steps
+ * @param r `uint16_t*`: `count` radii in 0.01 mm
+ * @param dz_values `int16_t*`: `count` heights, may be `NULL` without `dz`
+ * @return `bool`: `false` if the body is cut short or does not hold `count` points
+ */
+bool codec_ring_decode(const uint8_t* data, size_t length, uint16_t count, bool rle, bool dz,
+                       uint16_t* angles, uint16_t* r, int16_t* dz_values) {
+    if (length < CODEC_RING_HEADER_BYTES) return false;
+    uint16_t angle = data[0] | (data[1] << 8);
+    uint16_t step = data[2] | (data[3] << 8);
+    rle = rle && !dz;
+
+    size_t offset = CODEC_RING_HEADER_BYTES;
+    uint16_t last_r = 0;
+    uint32_t run = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (run == 0) {
+            uint32_t symbol;
+            size_t used = codec_get_varint(data + offset, length - offset, &symbol);
+            if (used == 0) return false;
+            offset += used;
+            if (rle && (symbol & 1)) {
+                run = symbol >> 1;
+            } else {
+                last_r += codec_unzigzag(rle ? symbol >> 1 : symbol);
+            }
+        }
+        if (run > 0) run--;
+
+        if (dz) {
+            uint32_t symbol;
+            size_t used = codec_get_varint(data + offset, length - offset, &symbol);
+            if (used == 0) return false;
+            offset += used;
+            if (dz_values != NULL) dz_values[i] = codec_unzigzag(symbol);
+        }
+        angles[i] = angle + i * step;
+        r[i] = last_r;
+    }
+    return offset == length && run == 0;
+}
+
+/**
+ * @brief Write a LEB128 varint, 7 bits per byte, low bits first
+ *
+ * @return `size_t`: the bytes written, up to 5
+ */
+size_t codec_put_varint(uint8_t* buffer, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        buffer[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buffer[length++] = value;
+    return length;
+}
+
+/**
+ * @brief Read a LEB128 varint
+ *
+ * @return `size_t`: the bytes read, `0` if the varint is cut short or longer than 5 bytes
+ */
+size_t codec_get_varint(const uint8_t* buffer, size_t length, uint32_t* value) {
+    *value = 0;
+    for (size_t i = 0; i < length && i < 5; i++) {
+        *value |= (uint32_t)(buffer[i] & 0x7F) << (7 * i);
+        if (!(buffer[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
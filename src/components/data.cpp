@@ -493,3 +493,507 @@ void get_module(uint16_t* z_axis_max, uint16_t* z_axis_start_step, uint16_t* z_a
         nvs_close(nvs_handle);
     }
 }
+
+/**
+ * @brief Set the motion profile limits of both axes
+ * 
+ * @param z_axis_max_speed `uint32_t`: Z axis cruise speed in steps/s
+ * @param z_axis_acceleration `uint32_t`: Z axis acceleration in steps/s^2
+ * @param z_axis_jerk `uint32_t`: Z axis jerk in steps/s^3, `0` for a trapezoidal profile
+ * @param x_y_axis_max_speed `uint32_t`: X Y axis cruise speed in steps/s
+ * @param x_y_axis_acceleration `uint32_t`: X Y axis acceleration in steps/s^2
+ * @param x_y_axis_jerk `uint32_t`: X Y axis jerk in steps/s^3, `0` for a trapezoidal profile
+ */
+void set_motion(uint32_t z_axis_max_speed, uint32_t z_axis_acceleration, uint32_t z_axis_jerk,
+                uint32_t x_y_axis_max_speed, uint32_t x_y_axis_acceleration, uint32_t x_y_axis_jerk) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Motion NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_u32(nvs_handle, NVS_Z_AXIS_MAX_SPEED, z_axis_max_speed);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing Z axis max speed to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u32(nvs_handle, NVS_Z_AXIS_ACCELERATION, z_axis_acceleration);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing Z axis acceleration to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u32(nvs_handle, NVS_Z_AXIS_JERK, z_axis_jerk);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing Z axis jerk to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u32(nvs_handle, NVS_X_Y_AXIS_MAX_SPEED, x_y_axis_max_speed);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing X Y axis max speed to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u32(nvs_handle, NVS_X_Y_AXIS_ACCELERATION, x_y_axis_acceleration);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing X Y axis acceleration to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u32(nvs_handle, NVS_X_Y_AXIS_JERK, x_y_axis_jerk);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing X Y axis jerk to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+void get_motion(uint32_t* z_axis_max_speed, uint32_t* z_axis_acceleration, uint32_t* z_axis_jerk,
+                uint32_t* x_y_axis_max_speed, uint32_t* x_y_axis_acceleration, uint32_t* x_y_axis_jerk) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Motion NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_get_u32(nvs_handle, NVS_Z_AXIS_MAX_SPEED, z_axis_max_speed);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading Z axis max speed from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading Z axis max speed from NVS", esp_err_to_name(err));
+            *z_axis_max_speed = NVS_Z_AXIS_MAX_SPEED_DEFAULT;
+        }
+        err = nvs_get_u32(nvs_handle, NVS_Z_AXIS_ACCELERATION, z_axis_acceleration);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading Z axis acceleration from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading Z axis acceleration from NVS", esp_err_to_name(err));
+            *z_axis_acceleration = NVS_Z_AXIS_ACCELERATION_DEFAULT;
+        }
+        err = nvs_get_u32(nvs_handle, NVS_Z_AXIS_JERK, z_axis_jerk);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading Z axis jerk from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading Z axis jerk from NVS", esp_err_to_name(err));
+            *z_axis_jerk = NVS_Z_AXIS_JERK_DEFAULT;
+        }
+        err = nvs_get_u32(nvs_handle, NVS_X_Y_AXIS_MAX_SPEED, x_y_axis_max_speed);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading X Y axis max speed from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading X Y axis max speed from NVS", esp_err_to_name(err));
+            *x_y_axis_max_speed = NVS_X_Y_AXIS_MAX_SPEED_DEFAULT;
+        }
+        err = nvs_get_u32(nvs_handle, NVS_X_Y_AXIS_ACCELERATION, x_y_axis_acceleration);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading X Y axis acceleration from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading X Y axis acceleration from NVS", esp_err_to_name(err));
+            *x_y_axis_acceleration = NVS_X_Y_AXIS_ACCELERATION_DEFAULT;
+        }
+        err = nvs_get_u32(nvs_handle, NVS_X_Y_AXIS_JERK, x_y_axis_jerk);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading X Y axis jerk from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading X Y axis jerk from NVS", esp_err_to_name(err));
+            *x_y_axis_jerk = NVS_X_Y_AXIS_JERK_DEFAULT;
+        }
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Set when the stream task sends a batch of points
+ * 
+ * @param batch_points `uint16_t`: send once this many points are waiting
+ * @param batch_bytes `uint16_t`: send once the frame would grow past this many bytes
+ * @param batch_time `uint16_t`: send once the oldest waiting point is this many ms old
+ * @param batch_ring `uint8_t`: `1` to send at the end of every ring
+ * @param status_time `uint16_t`: the status frame period in ms while stopped
+ */
+void set_stream(uint16_t batch_points, uint16_t batch_bytes, uint16_t batch_time, uint8_t batch_ring, uint16_t status_time) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Stream NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_u16(nvs_handle, NVS_STREAM_BATCH_POINTS, batch_points);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing stream batch points to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u16(nvs_handle, NVS_STREAM_BATCH_BYTES, batch_bytes);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing stream batch bytes to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u16(nvs_handle, NVS_STREAM_BATCH_TIME, batch_time);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing stream batch time to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u8(nvs_handle, NVS_STREAM_BATCH_RING, batch_ring);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing stream batch ring to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u16(nvs_handle, NVS_STREAM_STATUS_TIME, status_time);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing stream status time to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+void get_stream(uint16_t* batch_points, uint16_t* batch_bytes, uint16_t* batch_time, uint8_t* batch_ring, uint16_t* status_time) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Stream NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_get_u16(nvs_handle, NVS_STREAM_BATCH_POINTS, batch_points);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading stream batch points from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading stream batch points from NVS", esp_err_to_name(err));
+            *batch_points = NVS_STREAM_BATCH_POINTS_DEFAULT;
+        }
+        err = nvs_get_u16(nvs_handle, NVS_STREAM_BATCH_BYTES, batch_bytes);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading stream batch bytes from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading stream batch bytes from NVS", esp_err_to_name(err));
+            *batch_bytes = NVS_STREAM_BATCH_BYTES_DEFAULT;
+        }
+        err = nvs_get_u16(nvs_handle, NVS_STREAM_BATCH_TIME, batch_time);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading stream batch time from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading stream batch time from NVS", esp_err_to_name(err));
+            *batch_time = NVS_STREAM_BATCH_TIME_DEFAULT;
+        }
+        err = nvs_get_u8(nvs_handle, NVS_STREAM_BATCH_RING, batch_ring);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading stream batch ring from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading stream batch ring from NVS", esp_err_to_name(err));
+            *batch_ring = NVS_STREAM_BATCH_RING_DEFAULT;
+        }
+        err = nvs_get_u16(nvs_handle, NVS_STREAM_STATUS_TIME, status_time);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading stream status time from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading stream status time from NVS", esp_err_to_name(err));
+            *status_time = NVS_STREAM_STATUS_TIME_DEFAULT;
+        }
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Set the adaptive sampling of a point
+ * 
+ * @param sample_bound `uint16_t`: stop once the distance is known to within this bound, in 0.01 mm, `0` to turn off
+ * @param sample_min `uint16_t`: the fewest samples of a point
+ * @param sample_max `uint16_t`: the most samples of a point
+ */
+void set_sampling(uint16_t sample_bound, uint16_t sample_min, uint16_t sample_max) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Sampling NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_u16(nvs_handle, NVS_SAMPLE_BOUND, sample_bound);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing sample bound to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u16(nvs_handle, NVS_SAMPLE_MIN, sample_min);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing sample min to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u16(nvs_handle, NVS_SAMPLE_MAX, sample_max);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing sample max to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+void get_sampling(uint16_t* sample_bound, uint16_t* sample_min, uint16_t* sample_max) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Sampling NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_get_u16(nvs_handle, NVS_SAMPLE_BOUND, sample_bound);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading sample bound from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading sample bound from NVS", esp_err_to_name(err));
+            *sample_bound = NVS_SAMPLE_BOUND_DEFAULT;
+        }
+        err = nvs_get_u16(nvs_handle, NVS_SAMPLE_MIN, sample_min);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading sample min from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading sample min from NVS", esp_err_to_name(err));
+            *sample_min = NVS_SAMPLE_MIN_DEFAULT;
+        }
+        err = nvs_get_u16(nvs_handle, NVS_SAMPLE_MAX, sample_max);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading sample max from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading sample max from NVS", esp_err_to_name(err));
+            *sample_max = NVS_SAMPLE_MAX_DEFAULT;
+        }
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Set the point filter, applied after a reboot
+ * 
+ * @param window `uint8_t`: points of a ring the filter looks at, `0` to turn it off
+ * @param outlier `uint16_t`: off the neighbour median that marks a point suspect, in 0.01 mm, `0` to skip
+ * @param ring `uint16_t`: off the previous ring that marks a point suspect, in 0.01 mm, `0` to skip
+ * @param smooth `uint8_t`: `1` gives good points the median radius of their window
+ * @param drop `uint8_t`: `1` leaves suspect points out
+ */
+void set_filter(uint8_t window, uint16_t outlier, uint16_t ring, uint8_t smooth, uint8_t drop) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Filter NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_u8(nvs_handle, NVS_FILTER_WINDOW, window);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing filter window to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u16(nvs_handle, NVS_FILTER_OUTLIER, outlier);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing filter outlier to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u16(nvs_handle, NVS_FILTER_RING, ring);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing filter ring to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u8(nvs_handle, NVS_FILTER_SMOOTH, smooth);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing filter smooth to NVS", esp_err_to_name(err));
+        }
+        err = nvs_set_u8(nvs_handle, NVS_FILTER_DROP, drop);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing filter drop to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+void get_filter(uint8_t* window, uint16_t* outlier, uint16_t* ring, uint8_t* smooth, uint8_t* drop) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Filter NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_get_u8(nvs_handle, NVS_FILTER_WINDOW, window);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading filter window from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading filter window from NVS", esp_err_to_name(err));
+            *window = NVS_FILTER_WINDOW_DEFAULT;
+        }
+        err = nvs_get_u16(nvs_handle, NVS_FILTER_OUTLIER, outlier);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading filter outlier from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading filter outlier from NVS", esp_err_to_name(err));
+            *outlier = NVS_FILTER_OUTLIER_DEFAULT;
+        }
+        err = nvs_get_u16(nvs_handle, NVS_FILTER_RING, ring);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading filter ring from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading filter ring from NVS", esp_err_to_name(err));
+            *ring = NVS_FILTER_RING_DEFAULT;
+        }
+        err = nvs_get_u8(nvs_handle, NVS_FILTER_SMOOTH, smooth);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading filter smooth from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading filter smooth from NVS", esp_err_to_name(err));
+            *smooth = NVS_FILTER_SMOOTH_DEFAULT;
+        }
+        err = nvs_get_u8(nvs_handle, NVS_FILTER_DROP, drop);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading filter drop from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading filter drop from NVS", esp_err_to_name(err));
+            *drop = NVS_FILTER_DROP_DEFAULT;
+        }
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Set the edge of the voxels points are merged in, applied after a reboot
+ * 
+ * @param size `uint16_t`: the edge in 0.01 mm, `0` sends every point
+ */
+void set_voxel(uint16_t size) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Voxel NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_u16(nvs_handle, NVS_VOXEL_SIZE, size);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing voxel size to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+void get_voxel(uint16_t* size) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Voxel NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_get_u16(nvs_handle, NVS_VOXEL_SIZE, size);
+        if (err != ESP_OK) {
+            if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading voxel size from NVS", esp_err_to_name(err));
+            else ESP_LOGE(NVS_TAG, "Error (%s) reading voxel size from NVS", esp_err_to_name(err));
+            *size = NVS_VOXEL_SIZE_DEFAULT;
+        }
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Save the VL53 sensors
+ * 
+ * @param sensors `const void*`: the sensors
+ * @param length `size_t`: the size of all sensors
+ */
+void set_vl53_sensors(const void* sensors, size_t length) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Sensor NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_blob(nvs_handle, NVS_VL53_SENSORS, sensors, length);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing VL53 sensors to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Load the VL53 sensors
+ * 
+ * @param sensors `void*`: the sensors
+ * @param length `size_t`: the size of the room for the sensors
+ * @return `size_t`: the size of the loaded sensors, `0` if there are none or they do not fit
+ */
+size_t get_vl53_sensors(void* sensors, size_t length) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Sensor NVS handle", esp_err_to_name(err));
+        return 0;
+    }
+
+    size_t stored = length;
+    err = nvs_get_blob(nvs_handle, NVS_VL53_SENSORS, sensors, &stored);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading VL53 sensors from NVS", esp_err_to_name(err));
+        else ESP_LOGE(NVS_TAG, "Error (%s) reading VL53 sensors from NVS", esp_err_to_name(err));
+        return 0;
+    }
+    return stored;
+}
+
+/**
+ * @brief Save the distance offsets of the VL53L1X zones
+ * 
+ * @param offsets `const int16_t*`: the offset in mm of every zone
+ * @param count `uint8_t`: the number of zones
+ */
+void set_zone_offsets(const int16_t* offsets, uint8_t count) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Zone NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_blob(nvs_handle, NVS_ZONE_OFFSETS, offsets, count * sizeof(int16_t));
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing zone offsets to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Load the distance offsets of the VL53L1X zones, `NVS_ZONE_OFFSET_DEFAULT` if they were saved for another zone count
+ * 
+ * @param offsets `int16_t*`: the offset in mm of every zone
+ * @param count `uint8_t`: the number of zones
+ */
+void get_zone_offsets(int16_t* offsets, uint8_t count) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Zone NVS handle", esp_err_to_name(err));
+        for (uint8_t i = 0; i < count; i++) offsets[i] = NVS_ZONE_OFFSET_DEFAULT;
+        return;
+    }
+
+    size_t length = count * sizeof(int16_t);
+    err = nvs_get_blob(nvs_handle, NVS_ZONE_OFFSETS, offsets, &length);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(NVS_TAG, "Error (%s) reading zone offsets from NVS", esp_err_to_name(err));
+        else ESP_LOGE(NVS_TAG, "Error (%s) reading zone offsets from NVS", esp_err_to_name(err));
+    }
+    if (err != ESP_OK || length != count * sizeof(int16_t)) {
+        for (uint8_t i = 0; i < count; i++) offsets[i] = NVS_ZONE_OFFSET_DEFAULT;
+    }
+}
+
+/**
+ * @brief Save the scan checkpoint
+ * 
+ * @param checkpoint `const void*`: the checkpoint
+ * @param length `size_t`: the checkpoint size
+ */
+void set_checkpoint(const void* checkpoint, size_t length) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Checkpoint NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_set_blob(nvs_handle, NVS_CHECKPOINT, checkpoint, length);
+        if (err != ESP_OK) {
+            ESP_LOGE(NVS_TAG, "Error (%s) writing checkpoint to NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Load the scan checkpoint
+ * 
+ * @param checkpoint `void*`: the checkpoint
+ * @param length `size_t`: the checkpoint size
+ * @return `bool`: `false` if there is no checkpoint or it has another size
+ */
+bool get_checkpoint(void* checkpoint, size_t length) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Checkpoint NVS handle", esp_err_to_name(err));
+        return false;
+    }
+
+    size_t stored = length;
+    err = nvs_get_blob(nvs_handle, NVS_CHECKPOINT, checkpoint, &stored);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        if (err == ESP_ERR_NVS_NOT_FOUND) ESP_LOGD(NVS_TAG, "No checkpoint in NVS");
+        else ESP_LOGE(NVS_TAG, "Error (%s) reading checkpoint from NVS", esp_err_to_name(err));
+        return false;
+    }
+    return stored == length;
+}
+
+void clear_checkpoint() {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(NVS_STORAGE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(NVS_TAG, "Error (%s) opening Checkpoint NVS handle", esp_err_to_name(err));
+    } else {
+        err = nvs_erase_key(nvs_handle, NVS_CHECKPOINT);
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(NVS_TAG, "Error (%s) erasing checkpoint from NVS", esp_err_to_name(err));
+        }
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
@@ -0,0 +1,147 @@
+// Path: src/components/estimator.cpp
+#include "components/estimator.h"    // include/components/estimator.h
+
+const char* ESTIMATOR_TAG = ESTIMATOR_TAG_NAME;
+
+void estimator_sort(uint16_t* samples, uint16_t count);
+
+/**
+ * @brief Start the samples of a new point, nothing is allocated
+ *
+ * @param estimator `estimator_t*`: the estimator
+ * @param type `uint8_t`: `ESTIMATOR_MODE`, `ESTIMATOR_MEDIAN` or `ESTIMATOR_TRIMMED_MEAN`
+ * @param min `uint16_t`: the smallest valid sample
+ * @param max `uint16_t`: the largest valid sample
+ */
+void estimator_begin(estimator_t* estimator, uint8_t type, uint16_t min, uint16_t max) {
+    estimator->type = type;
+    estimator->min = min;
+    estimator->max = max;
+    estimator->bin_width = (max - min) / ESTIMATOR_BINS + 1;
+    estimator->count = 0;
+    estimator->mean = 0;
+    estimator->m2 = 0;
+    estimator->mode_bin = 0;
+    if (type == ESTIMATOR_MODE) memset(estimator->histogram, 0, sizeof(estimator->histogram));
+}
+
+/**
+ * @brief Add a sample
+ *
+ * @param estimator `estimator_t*`: the estimator
+ * @param sample `uint16_t`: the sample
+ * @return `bool`: `false` if the sample is outside the window or the estimator is full
+ */
+bool estimator_add(estimator_t* estimator, uint16_t sample) {
+    if (sample < estimator->min || sample > estimator->max) return false;
+    if (estimator->count >= ESTIMATOR_MAX_SAMPLES) return false;
+
+    estimator->samples[estimator->count++] = sample;
+
+    // Welford, the running variance stays exact without keeping a sum of squares
+    float delta = sample - estimator->mean;
+    estimator->mean += delta / estimator->count;
+    estimator->m2 += delta * (sample - estimator->mean);
+    if (estimator->type == ESTIMATOR_MODE) {
+        uint16_t index = (sample - estimator->min) / estimator->bin_width;
+        uint8_t* bin = &estimator->histogram[index];
+        if (*bin < UINT8_MAX) (*bin)++;
+
+        uint8_t best = estimator->histogram[estimator->mode_bin];
+        if (*bin > best || ( *bin == best && index < estimator->mode_bin )) estimator->mode_bin = index;
+    }
+    return true;
+}
+
+uint16_t estimator_count(const estimator_t* estimator) {
+    return estimator->count;
+}
+
+/**
+ * @brief The sample variance
+ *
+ * @param estimator `const estimator_t*`: the estimator
+ * @return `float`: the variance in mm², `0` below two samples
+ */
+float estimator_variance(const estimator_t* estimator) {
+    if (estimator->count < 2) return 0;
+    return estimator->m2 / (estimator->count - 1);
+}
+
+/**
+ * @brief The mean of the samples is known to within a bound
+ *
+ * @param estimator `const estimator_t*`: the estimator
+ * @param bound `float`: the half width of the confidence interval in mm
+ * @return `bool`: `true` once `ESTIMATOR_CONFIDENCE_Z` standard errors fit in the bound, needs two samples
+ */
+bool estimator_confident(const estimator_t* estimator, float bound) {
+    if (estimator->count < 2) return false;
+    return ESTIMATOR_CONFIDENCE_Z * ESTIMATOR_CONFIDENCE_Z * estimator_variance(estimator) <= bound * bound * estimator->count;
+}
+
+/**
+ * @brief The value of the samples
+ *
+ * The mode takes the fullest histogram bin, the lowest one on a tie, and averages the samples in it.
+ * The bin is tracked while adding, so the result does not scan the histogram.
+ * The median and the trimmed mean sort the samples in place.
+ *
+ * @param estimator `estimator_t*`: the estimator
+ * @return `uint16_t`: the value, `0` without samples
+ */
+uint16_t estimator_result(estimator_t* estimator) {
+    if (estimator->count == 0) return 0;
+
+    if (estimator->type == ESTIMATOR_MODE) {
+        uint16_t best = estimator->mode_bin;
+        if (estimator->bin_width == 1) return estimator->min + best;
+
+        uint32_t sum = 0;
+        uint16_t count = 0;
+        for (uint16_t i = 0; i < estimator->count; i++) {
+            if ((estimator->samples[i] - estimator->min) / estimator->bin_width == best) {
+                sum += estimator->samples[i];
+                count++;
+            }
+        }
+        return (sum + count / 2) / count;
+    }
+
+    estimator_sort(estimator->samples, estimator->count);
+
+    if (estimator->type == ESTIMATOR_MEDIAN) {
+        uint16_t middle = estimator->count / 2;
+        if (estimator->count % 2) return estimator->samples[middle];
+        return (estimator->samples[middle - 1] + estimator->samples[middle] + 1) / 2;
+    }
+
+    uint16_t trim = estimator->count * ESTIMATOR_TRIM_PERCENT / 100;
+    uint32_t sum = 0;
+    for (uint16_t i = trim; i < estimator->count - trim; i++) {
+        sum += estimator->samples[i];
+    }
+    uint16_t count = estimator->count - 2 * trim;
+    return (sum + count / 2) / count;
+}
+
+/**
+ * @brief Insertion sort, the samples of a point are few and often almost sorted
+ */
+void estimator_sort(uint16_t* samples, uint16_t count) {
+    for (uint16_t i = 1; i < count; i++) {
+        uint16_t value = samples[i];
+        uint16_t j = i;
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+}
+
+uint8_t estimator_from_name(const char* name) {
+    if (name != NULL && strcmp(name, "median") == 0) return ESTIMATOR_MEDIAN;
+    if (name != NULL && strcmp(name, "mean") == 0) return ESTIMATOR_TRIMMED_MEAN;
+    return ESTIMATOR_MODE;
+}
@@ -0,0 +1,207 @@
+// Path: src/components/exporter.cpp
+#include "components/exporter.h"    // include/components/exporter.h
+
+#include "components/module.h"
+
+const char* EXPORTER_TAG = EXPORTER_TAG_NAME;
+
+void exporter_rewind(exporter_t* exporter);
+bool exporter_next(exporter_t* exporter);
+bool exporter_next_record(exporter_t* exporter, recorder_record_t* record);
+uint32_t exporter_count_surface(exporter_t* exporter);
+
+/**
+ * @brief Open a recording for download
+ *
+ * @param exporter `exporter_t*`: the download
+ * @param name `const char*`: the project name of the recording
+ * @param format `uint8_t`: `EXPORTER_FORMAT_*`
+ * @return `bool`: `false` if there is no such recording or it can not be read
+ */
+bool exporter_open(exporter_t* exporter, const char* name, uint8_t format) {
+    fs::FS* fs = recorder_filesystem();
+    if (fs == NULL) return false;
+
+    String path = recorder_path(name) + ".bin";
+    if (!fs->exists(path.c_str())) return false;
+    exporter->file = fs->open(path.c_str(), FILE_READ);
+    if (!exporter->file) return false;
+
+    recorder_header_t header;
+    memset(&header, 0, sizeof(header));
+    if (exporter->file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, RECORDER_MAGIC, sizeof(header.magic)) != 0 ||
+        !recorder_record_size_valid(header.record_size) || header.header_size != RECORDER_HEADER_SIZE) {
+        ESP_LOGW(EXPORTER_TAG, "%s is not a recording", path.c_str());
+        exporter->file.close();
+        return false;
+    }
+
+    // A recording still being written is cut at its last sync
+    exporter->format = format;
+    exporter->record_size = header.record_size;
+    exporter->records = header.records;
+    strncpy(exporter->name, header.name, RECORDER_NAME_LENGTH - 1);
+    exporter->name[RECORDER_NAME_LENGTH - 1] = '\0';
+    exporter_rewind(exporter);
+    exporter->surface = header.version >= 2 ? header.surface : exporter_count_surface(exporter);
+    ESP_LOGI(EXPORTER_TAG, "Export %s, records: %u, format: %u", path.c_str(), exporter->records, format);
+    return true;
+}
+
+/**
+ * @brief Size of the download
+ *
+ * @param exporter `const exporter_t*`: the download
+ * @return `size_t`: the size in bytes, `0` for the text formats, whose size is only known at the end
+ */
+size_t exporter_length(const exporter_t* exporter) {
+    if (exporter->format == EXPORTER_FORMAT_RAW) return RECORDER_HEADER_SIZE + exporter->records * exporter->record_size;
+    if (exporter->format != EXPORTER_FORMAT_PLY) return 0;
+
+    char header[EXPORTER_PENDING_SIZE];
+    int length = snprintf(header, sizeof(header),
+                          "ply\nformat binary_little_endian 1.0\ncomment %s\nelement vertex %u\n"
+                          "property float x\nproperty float y\nproperty float z\nend_header\n",
+                          exporter->name, exporter->surface);
+    return length + exporter->surface * 3 * sizeof(float);
+}
+
+/**
+ * @brief Fill a piece of the download, called by the web server as the client takes the data
+ *
+ * Reading on from the last piece streams the records, an offset behind it reads them again from the start.
+ *
+ * @param exporter `exporter_t*`: the download
+ * @param buffer `uint8_t*`: the piece
+ * @param max_length `size_t`: the room of the piece
+ * @param offset `size_t`: the offset of the piece in the download
+ * @return `size_t`: the bytes filled, `0` at the end
+ */
+size_t exporter_read(exporter_t* exporter, uint8_t* buffer, size_t max_length, size_t offset) {
+    if (exporter->format == EXPORTER_FORMAT_RAW) {
+        size_t length = exporter_length(exporter);
+        if (offset >= length) return 0;
+        exporter->file.seek(offset);
+        return exporter->file.read(buffer, min(max_length, length - offset));
+    }
+
+    if (offset < exporter->offset) exporter_rewind(exporter);
+
+    size_t filled = 0;
+    while (filled < max_length) {
+        if (exporter->pending_sent == exporter->pending_length && !exporter_next(exporter)) break;
+
+        size_t available = exporter->pending_length - exporter->pending_sent;
+        size_t position = exporter->offset + exporter->pending_sent;
+        if (position < offset) {
+            exporter->pending_sent += min(available, offset - position);
+            continue;
+        }
+        size_t length = min(available, max_length - filled);
+        memcpy(buffer + filled, exporter->pending + exporter->pending_sent, length);
+        exporter->pending_sent += length;
+        filled += length;
+    }
+    return filled;
+}
+
+void exporter_close(exporter_t* exporter) {
+    if (exporter->file) exporter->file.close();
+}
+
+void exporter_rewind(exporter_t* exporter) {
+    exporter->offset = 0;
+    exporter->record = 0;
+    exporter->header_done = false;
+    exporter->pending_length = 0;
+    exporter->pending_sent = 0;
+    exporter->block_count = 0;
+    exporter->block_next = 0;
+    exporter->file.seek(RECORDER_HEADER_SIZE);
+}
+
+/**
+ * @brief Turn the header or the next surface record into output
+ *
+ * @return `bool`: `false` after the last record
+ */
+bool exporter_next(exporter_t* exporter) {
+    exporter->offset += exporter->pending_length;
+    exporter->pending_length = 0;
+    exporter->pending_sent = 0;
+
+    if (!exporter->header_done) {
+        exporter->header_done = true;
+        if (exporter->format == EXPORTER_FORMAT_XYZ) return exporter_next(exporter);
+        exporter->pending_length = snprintf(exporter->pending, EXPORTER_PENDING_SIZE,
+                                            "ply\nformat %s 1.0\ncomment %s\nelement vertex %u\n"
+                                            "property float x\nproperty float y\nproperty float z\nend_header\n",
+                                            exporter->format == EXPORTER_FORMAT_PLY ? "binary_little_endian" : "ascii",
+                                            exporter->name, exporter->surface);
+        return true;
+    }
+
+    recorder_record_t record;
+    do {
+        if (!exporter_next_record(exporter, &record)) return false;
+    } while (record.flags & POINT_FLAG_NO_SURFACE);
+
+    int32_t x = 0, y = 0;
+    get_x_y(record.x_y_steps, record.r, &x, &y);
+    int32_t z = get_z(record.z_steps);
+
+    if (exporter->format == EXPORTER_FORMAT_PLY) {
+        float vertex[3] = { x / 100.0f, y / 100.0f, z / 100.0f };
+        memcpy(exporter->pending, vertex, sizeof(vertex));
+        exporter->pending_length = sizeof(vertex);
+    } else {
+        exporter->pending_length = snprintf(exporter->pending, EXPORTER_PENDING_SIZE, "%.2f %.2f %.2f\n", x / 100.0, y / 100.0, z / 100.0);
+    }
+    return true;
+}
+
+bool exporter_next_record(exporter_t* exporter, recorder_record_t* record) {
+    if (exporter->record >= exporter->records) return false;
+    if (exporter->block_next >= exporter->block_count) {
+        uint32_t count = min((uint32_t)EXPORTER_READ_RECORDS, exporter->records - exporter->record);
+        exporter->block_count = recorder_read_records(exporter->file, exporter->record_size, exporter->block, count);
+        exporter->block_next = 0;
+        if (exporter->block_count == 0) return false;
+    }
+    *record = exporter->block[exporter->block_next++];
+    exporter->record++;
+    return true;
+}
+
+/**
+ * @brief Count the surface records of a version 1 recording, whose header does not have them
+ */
+uint32_t exporter_count_surface(exporter_t* exporter) {
+    uint32_t surface = 0;
+    recorder_record_t record;
+    while (exporter_next_record(exporter, &record)) {
+        if (!(record.flags & POINT_FLAG_NO_SURFACE)) surface++;
+    }
+    exporter_rewind(exporter);
+    return surface;
+}
+
+uint8_t exporter_format_from_name(const char* name) {
+    if (name == NULL) return EXPORTER_FORMAT_PLY;
+    if (strcmp(name, "raw") == 0) return EXPORTER_FORMAT_RAW;
+    if (strcmp(name, "ply_ascii") == 0) return EXPORTER_FORMAT_PLY_ASCII;
+    if (strcmp(name, "xyz") == 0) return EXPORTER_FORMAT_XYZ;
+    return EXPORTER_FORMAT_PLY;
+}
+
+const char* exporter_content_type(uint8_t format) {
+    if (format == EXPORTER_FORMAT_PLY_ASCII || format == EXPORTER_FORMAT_XYZ) return "text/plain";
+    return "application/octet-stream";
+}
+
+const char* exporter_extension(uint8_t format) {
+    if (format == EXPORTER_FORMAT_RAW) return "bin";
+    if (format == EXPORTER_FORMAT_XYZ) return "xyz";
+    return "ply";
+}
@@ -0,0 +1,160 @@
+// Path: src/components/filter.cpp
+#include "components/filter.h"    // include/components/filter.h
+
+const char* FILTER_TAG = FILTER_TAG_NAME;
+
+uint16_t filter_median(uint16_t* values, uint8_t count);
+uint8_t filter_window(const filter_config_t* config);
+void filter_judge(filter_t* filter, const filter_config_t* config, uint8_t index, scanner_point_t* point);
+
+/**
+ * @brief Start a scan, no previous ring, nothing is allocated
+ *
+ * @param filter `filter_t*`: the filter
+ */
+void filter_begin(filter_t* filter) {
+    filter->count = 0;
+    filter->next = 0;
+    filter->ending = false;
+    filter->current = 0;
+    filter->previous_valid = false;
+    memset(filter->radius, 0, sizeof(filter->radius));
+}
+
+/**
+ * @brief Add the next point of the ring, hand the judged points out with `filter_pop` before the next push
+ *
+ * @param filter `filter_t*`: the filter
+ * @param config `const filter_config_t*`: the settings
+ * @param point `const scanner_point_t*`: the point
+ * @return `bool`: `false` if the window is still full of points not handed out
+ */
+bool filter_push(filter_t* filter, const filter_config_t* config, const scanner_point_t* point) {
+    if (filter->ending) {
+        // The points of the last ring are all out, they become the previous ring
+        filter->count = 0;
+        filter->next = 0;
+        filter->ending = false;
+        filter->current ^= 1;
+        filter->previous_valid = true;
+        memset(filter->radius[filter->current], 0, sizeof(filter->radius[0]));
+    }
+
+    uint8_t window = filter_window(config);
+    if (filter->count >= window) {
+        if (filter->next == 0) return false;
+        memmove(&filter->points[0], &filter->points[1], (filter->count - 1) * sizeof(scanner_point_t));
+        filter->count--;
+        filter->next--;
+    }
+    filter->points[filter->count++] = *point;
+    return true;
+}
+
+/**
+ * @brief Hand out the next judged point, a point waits for half a window of points after it unless the ring ended
+ *
+ * The point carries `POINT_FLAG_FILTERED`, and `POINT_FLAG_SUSPECT` if it disagrees with its neighbours on the
+ * ring or with the previous ring. A good point gets the median radius of its window when `smooth` is set.
+ *
+ * @param filter `filter_t*`: the filter
+ * @param config `const filter_config_t*`: the settings
+ * @param point `scanner_point_t*`: the point
+ * @return `bool`: `false` if no point is ready
+ */
+bool filter_pop(filter_t* filter, const filter_config_t* config, scanner_point_t* point) {
+    if (filter->next >= filter->count) return false;
+    uint8_t half = filter_window(config) / 2;
+    if (!filter->ending && filter->count - 1 - filter->next < half) return false;
+
+    *point = filter->points[filter->next];
+    filter_judge(filter, config, filter->next, point);
+    filter->next++;
+    return true;
+}
+
+/**
+ * @brief The ring ended, `filter_pop` hands out its last points without waiting for more
+ *
+ * @param filter `filter_t*`: the filter
+ */
+void filter_end_ring(filter_t* filter) {
+    if (filter->count > 0) filter->ending = true;
+}
+
+void filter_judge(filter_t* filter, const filter_config_t* config, uint8_t index, scanner_point_t* point) {
+    uint8_t half = filter_window(config) / 2;
+    uint8_t first = index > half ? index - half : 0;
+    uint8_t last = min((uint8_t)(index + half), (uint8_t)(filter->count - 1));
+    uint16_t bin = (uint32_t)point->x_y_steps * FILTER_RING_BINS / max(config->angle_max, (uint16_t)1);
+    bin = min(bin, (uint16_t)(FILTER_RING_BINS - 1));
+
+    point->flags |= POINT_FLAG_FILTERED;
+    if (point->flags & POINT_FLAG_NO_SURFACE) {
+        filter->radius[filter->current][bin] = 0;
+        return;
+    }
+
+    uint16_t neighbours[FILTER_WINDOW_MAX];
+    uint8_t count = 0;
+    for (uint8_t i = first; i <= last; i++) {
+        if (i != index && !(filter->points[i].flags & POINT_FLAG_NO_SURFACE)) neighbours[count++] = filter->points[i].r;
+    }
+
+    bool suspect = false;
+    if (config->outlier > 0 && last > first) {
+        // A point the surface does not go on from is a flyer or a mixed pixel at an edge
+        if (count * 2 < last - first) {
+            suspect = true;
+        } else if (count > 0) {
+            uint16_t median = filter_median(neighbours, count);
+            uint16_t deviations[FILTER_WINDOW_MAX];
+            for (uint8_t i = 0; i < count; i++) deviations[i] = abs((int32_t)neighbours[i] - median);
+            float limit = max((float)config->outlier, FILTER_MAD_LIMIT * filter_median(deviations, count));
+            suspect = abs((int32_t)point->r - median) > limit;
+        }
+    }
+
+    uint16_t previous = filter->radius[filter->current ^ 1][bin];
+    if (config->ring > 0 && filter->previous_valid && previous > 0) {
+        suspect = suspect || abs((int32_t)point->r - previous) > config->ring;
+    }
+
+    if (suspect) {
+        point->flags |= POINT_FLAG_SUSPECT;
+        filter->radius[filter->current][bin] = 0;
+        return;
+    }
+
+    if (config->smooth && count > 0) {
+        neighbours[count++] = point->r;
+        point->r = filter_median(neighbours, count);
+    }
+    filter->radius[filter->current][bin] = point->r;
+}
+
+/**
+ * @brief Median of a few values, sorts them in place
+ *
+ * @param values `uint16_t*`: the values
+ * @param count `uint8_t`: at least one
+ * @return `uint16_t`: the median, the mean of the middle two for an even count
+ */
+uint16_t filter_median(uint16_t* values, uint8_t count) {
+    for (uint8_t i = 1; i < count; i++) {
+        uint16_t value = values[i];
+        int8_t j = i - 1;
+        while (j >= 0 && values[j] > value) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = value;
+    }
+    if (count % 2 == 1) return values[count / 2];
+    return ((uint32_t)values[count / 2 - 1] + values[count / 2]) / 2;
+}
+
+uint8_t filter_window(const filter_config_t* config) {
+    uint8_t window = constrain(config->window, (uint8_t)1, (uint8_t)FILTER_WINDOW_MAX);
+    return window | 1;
+}
@@ -4,9 +4,9 @@
 const char* MODULE_TAG = MODULE_TAG_NAME;
 
 #ifdef CONFIG_VL53L1X
-Adafruit_VL53L1X vl53 = Adafruit_VL53L1X();
+Adafruit_VL53L1X vl53[VL53_SENSOR_MAX];
 #else
-Adafruit_VL53L0X vl53 = Adafruit_VL53L0X();
+Adafruit_VL53L0X vl53[VL53_SENSOR_MAX];
 #endif
 
 uint16_t z_axis_max = NVS_Z_AXIS_MAX_DEFAULT;
@@ -19,54 +19,149 @@ uint16_t x_y_axis_check_times = NVS_X_Y_AXIS_CHECK_TIMES_DEFAULT;
 uint16_t x_y_axis_step_delay_time = NVS_X_Y_AXIS_STEP_DELAY_TIME_DEFAULT;
 uint16_t x_y_axis_one_time_step = NVS_X_Y_AXIS_ONE_TIME_STEP_DEFAULT;
 
+uint32_t z_axis_max_speed = NVS_Z_AXIS_MAX_SPEED_DEFAULT;
+uint32_t z_axis_acceleration = NVS_Z_AXIS_ACCELERATION_DEFAULT;
+uint32_t z_axis_jerk = NVS_Z_AXIS_JERK_DEFAULT;
+
+uint32_t x_y_axis_max_speed = NVS_X_Y_AXIS_MAX_SPEED_DEFAULT;
+uint32_t x_y_axis_acceleration = NVS_X_Y_AXIS_ACCELERATION_DEFAULT;
+uint32_t x_y_axis_jerk = NVS_X_Y_AXIS_JERK_DEFAULT;
+
 uint16_t vl53l1x_center = NVS_VL53L1X_CENTER_DEFAULT;
 uint16_t vl53l1x_timeing_budget = NVS_VL53L1X_TIMEING_BUDGET_DEFAULT;
 
+uint16_t sample_bound = NVS_SAMPLE_BOUND_DEFAULT;
+uint16_t sample_min = NVS_SAMPLE_MIN_DEFAULT;
+uint16_t sample_max = NVS_SAMPLE_MAX_DEFAULT;
+
 uint8_t _command = SCANNER_COMMAND_STOP;
 uint64_t _steps = 0;
+bool motion_started = false;
+
+QueueHandle_t command_queue = NULL;
+TaskHandle_t scanner_task_handle = NULL;
+volatile bool scanner_abort = false;
+
+uint8_t scan_mode = SCAN_MODE_STEP;
+uint8_t scan_estimator = ESTIMATOR_MODE;
+
+// Fast skip, a stride of `skip_stride` points once `SKIP_AFTER` points in a row were empty, 0 is off
+uint16_t skip_stride = 0;
+skip_t scan_skip;
+uint8_t scan_state = SCAN_STATE_IDLE;
 
-uint32_t z_steps = 0;
 uint32_t x_y_steps = 0;
+// The next point starts a ring
+bool scan_ring_start = false;
+uint32_t x_y_ring_move = 0;
+int32_t ring_start_position = 0;
 
+// Sensor 0 is ready
 bool vl53_ready = false;
-bool sd_card_ready = false;
+uint32_t vl53_timeouts = 0;
 
+vl53_sensor_t vl53_sensors[VL53_SENSOR_MAX];
+uint8_t vl53_sensor_count = 1;
+bool vl53_sensor_ready[VL53_SENSOR_MAX];
+// A sensor has no interrupt pin, so the waits are cut short to poll it
+bool vl53_polled = false;
+// The interrupt of a sensor fired since its last measurement was read
+volatile bool vl53_int_fired[VL53_SENSOR_MAX];
+
+#ifdef CONFIG_VL53L1X
+// Samples are read with `vl53l1x_read_result`, the library only boots and configures the sensors
+uint8_t vl53_polarity[VL53_SENSOR_MAX];
+vl53l1x_result_t vl53_results[VL53_SENSOR_MAX];
+uint32_t vl53_i2c_clock = VL53L1X_I2C_CLOCK_FAST;
+uint32_t vl53_reads = 0;
+uint32_t vl53_reads_transactions = 0;
+#endif
+
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+uint8_t vl53_zone = 0;
+int16_t vl53_zone_offsets[VL53_ZONE_COUNT];
+// The measurement running when the ROI changed still uses the old one
+bool vl53_zone_settle = false;
+// Z axis travel of a ring, the zones span it at the center distance
+uint32_t vl53_ring_z_steps = NVS_Z_AXIS_ONE_TIME_STEP_DEFAULT * VL53_ZONE_COUNT;
+#endif
 String project_name = "";
-String message = "";
 
 uint64_t point_count = 0;
 
-uint16_t distance_max = 0;
-uint16_t distance_min = 0;
+scanner_checkpoint_t checkpoint;
+bool checkpoint_valid = false;
+unsigned long last_checkpoint_time = 0;
+uint8_t resume_state = RESUME_STATE_HOME;
 
-unsigned long start_time = 0;
-unsigned long last_send_data_time = 0;
+// Refine scan, see `scan_refine_loop`
+uint8_t refine_pass = REFINE_PASS_COARSE;
+uint32_t refine_z_origin = 0;
+int32_t refine_x_y_origin = 0;
+uint32_t refine_z_stride = 0;       // of the coarse rings
+uint32_t refine_x_y_stride = 0;     // of the coarse angles
+uint16_t refine_rings = 0;
+uint16_t refine_segments = 0;
+uint8_t refine_detail[REFINE_MAX_BANDS][REFINE_MAX_SEGMENTS / 8];
+uint16_t refine_radius[2][REFINE_MAX_SEGMENTS];     // last two coarse rings, in 0.01 mm
+uint8_t refine_current = 0;
+// Coarse pass: ring and segment, fine pass: band, sub ring, segment and index inside the segment
+uint16_t refine_ring = 0;
+uint16_t refine_sub = 0;
+uint16_t refine_segment = 0;
+uint16_t refine_index = 0;
+uint32_t refine_fine_points = 0;
 
-void writeFile(fs::FS &fs, const char * path, const char * message);
-void appendFile(fs::FS &fs, const char * path, const char * message);
-uint16_t get_count_distance(uint16_t count);
-uint16_t get_distance();
-void get_x_y(double angle, double r, double* x, double* y);
+// Helical scan, see `scan_helical_loop`
+uint32_t helix_z_origin = 0;
+uint32_t helix_turn = 0;
 
-int16_t findMode(const std::vector<int16_t>& numbers) {
-    std::unordered_map<int16_t, int16_t> frequencyMap;
+// Adaptive sampling stats of the scan
+uint32_t scan_samples = 0;
+uint32_t scan_points = 0;
 
-    for (int16_t num : numbers) {
-        frequencyMap[num]++;
-    }
+unsigned long start_time = 0;
+unsigned long last_send_data_time = 0;
+scan_range_t scan_ranges[VL53_SENSOR_MAX];
 
-    int16_t mode = numbers[0];
-    int16_t maxCount = 0;
+// One filter per sensor, or per zone, since the points of each one follow the ring on their own
+filter_config_t filter_config = {
+    NVS_FILTER_WINDOW_DEFAULT, NVS_FILTER_OUTLIER_DEFAULT, NVS_FILTER_RING_DEFAULT,
+    NVS_FILTER_SMOOTH_DEFAULT, NVS_FILTER_DROP_DEFAULT, 0
+};
+filter_t scan_filters[SCAN_FILTER_COUNT];
+uint32_t filter_suspect_points = 0;
+uint32_t filter_dropped_points = 0;
 
-    for (const auto& pair : frequencyMap) {
-        if (pair.second > maxCount) {
-            maxCount = pair.second;
-            mode = pair.first;
-        }
-    }
+// Voxel grid after the filter, off while `voxel_config.z_size` is 0
+uint16_t voxel_size = NVS_VOXEL_SIZE_DEFAULT;
+voxel_config_t voxel_config = { 0, 0, 0 };
+voxel_t scan_voxels;
+uint32_t voxel_input_points = 0;
 
-    return mode;
-}
+uint16_t get_distance();
+bool vl53_read(uint8_t sensor, uint16_t* distance);
+bool vl53_wait(uint32_t timeout_ms);
+uint32_t vl53_timeout_ms();
+void vl53_timeout(uint8_t sensor);
+uint8_t vl53_sensor_address(uint8_t sensor);
+void scan_emit_point(scanner_point_t* point);
+void scan_send_point(scanner_point_t* point);
+bool scan_filter_active();
+bool scan_voxel_active();
+void scan_voxel_flush(uint32_t z_floor);
+void scan_flush(bool last = false);
+void scan_points_begin();
+#ifdef CONFIG_VL53L1X
+void vl53_i2c_clock_init();
+#endif
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+void vl53_set_zone(uint8_t zone);
+int32_t vl53_zone_z_steps(uint8_t zone, double distance);
+uint32_t vl53_zone_ring_steps(double distance);
+#endif
+void apply_command(uint8_t command, uint32_t steps);
+void scanner_task(void* parameter);
 
 void module_data_init() {
     get_module( &z_axis_max, &z_axis_start_step, &z_axis_delay_time, &z_axis_one_time_step, 
@@ -75,17 +170,55 @@ void module_data_init() {
     ESP_LOGD(MODULE_TAG, "Z axis max: %u, start step: %u, delay time: %u, one time step: %u", z_axis_max, z_axis_start_step, z_axis_delay_time, z_axis_one_time_step);
     ESP_LOGD(MODULE_TAG, "X Y axis max: %u, check times: %u, step delay time: %u, one time step: %u", x_y_axis_max, x_y_axis_check_times, x_y_axis_step_delay_time, x_y_axis_one_time_step);
     ESP_LOGD(MODULE_TAG, "VL53L1X center: %u, timing budget: %u", vl53l1x_center, vl53l1x_timeing_budget);
-    distance_max = vl53l1x_center + 70;
-    distance_min = vl53l1x_center - 70;
+    get_motion( &z_axis_max_speed, &z_axis_acceleration, &z_axis_jerk,
+                &x_y_axis_max_speed, &x_y_axis_acceleration, &x_y_axis_jerk);
+    get_sampling(&sample_bound, &sample_min, &sample_max);
+    sample_min = constrain(sample_min, (uint16_t)1, (uint16_t)ESTIMATOR_MAX_SAMPLES);
+    sample_max = constrain(sample_max, sample_min, (uint16_t)ESTIMATOR_MAX_SAMPLES);
+    ESP_LOGD(MODULE_TAG, "Sample bound: %u, min: %u, max: %u", sample_bound, sample_min, sample_max);
+
+    // Sensor 0 alone, unless more were set
+    memset(vl53_sensors, 0, sizeof(vl53_sensors));
+    size_t length = get_vl53_sensors(vl53_sensors, sizeof(vl53_sensors));
+    vl53_sensor_count = length >= sizeof(vl53_sensor_t) ? length / sizeof(vl53_sensor_t) : 1;
+    if (length < sizeof(vl53_sensor_t)) vl53_sensors[0].xshut_pin = VL53_NO_PIN;
+    vl53_sensors[0].int_pin = VL53_INT_PIN;
+    vl53_sensors[0].center = vl53l1x_center;
+    vl53_sensors[0].angle_steps = 0;
+    vl53_sensors[0].z_steps = 0;
+    ESP_LOGD(MODULE_TAG, "VL53 sensors: %u", vl53_sensor_count);
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+    get_zone_offsets(vl53_zone_offsets, VL53_ZONE_COUNT);
+    vl53_ring_z_steps = vl53_zone_ring_steps(vl53_sensors[0].center);
+    ESP_LOGD(MODULE_TAG, "VL53L1X ring Z axis steps: %u at %u mm", vl53_ring_z_steps, vl53_sensors[0].center);
+#endif
+    get_filter(&filter_config.window, &filter_config.outlier, &filter_config.ring, &filter_config.smooth, &filter_config.drop);
+    filter_config.window = min(filter_config.window, (uint8_t)FILTER_WINDOW_MAX);
+    filter_config.angle_max = x_y_axis_max;
+    ESP_LOGD(MODULE_TAG, "Filter window: %u, outlier: %u, ring: %u, smooth: %u, drop: %u",
+             filter_config.window, filter_config.outlier, filter_config.ring, filter_config.smooth, filter_config.drop);
+
+    // The arc of a voxel is the voxel size at the center distance of the farthest sensor, closer surfaces get shorter arcs
+    get_voxel(&voxel_size);
+    if (voxel_size > 0) {
+        uint16_t center = 0;
+        for (uint8_t i = 0; i < vl53_sensor_count; i++) center = max(center, vl53_sensors[i].center);
+        uint32_t angle_bins = ceil(2 * PI * center * 100.0 / voxel_size);
+        voxel_config.angle_bins = constrain(angle_bins, (uint32_t)1, (uint32_t)x_y_axis_max);
+        voxel_config.angle_max = x_y_axis_max;
+        voxel_config.z_size = max(lround(voxel_size / 100.0 / Z_AXIS_STEP_MM), 1L);
+    }
+    ESP_LOGD(MODULE_TAG, "Voxel size: %u, angle bins: %u, Z axis steps: %u", voxel_size, voxel_config.angle_bins, voxel_config.z_size);
 }
 
 void motor_init() {
-    pinMode(Z_AXIS_MOTOR_STEP, OUTPUT);
-    pinMode(Z_AXIS_MOTOR_DIR, OUTPUT);
+    stepper_init(STEPPER_AXIS_Z, Z_AXIS_MOTOR_STEP, Z_AXIS_MOTOR_DIR);
+    stepper_set_limit(STEPPER_AXIS_Z, 0, z_axis_max, BUTTON_PIN, LOW);
+    planner_set_config(STEPPER_AXIS_Z, 500000 / max(z_axis_delay_time, (uint16_t)1), z_axis_max_speed, z_axis_acceleration, z_axis_jerk);
     pinMode(Z_AXIS_MOTOR_EN, OUTPUT);
 
-    pinMode(X_Y_AXIS_MOTOR_STEP, OUTPUT);
-    pinMode(X_Y_AXIS_MOTOR_DIR, OUTPUT);
+    stepper_init(STEPPER_AXIS_X_Y, X_Y_AXIS_MOTOR_STEP, X_Y_AXIS_MOTOR_DIR);
+    planner_set_config(STEPPER_AXIS_X_Y, 500000 / max(x_y_axis_step_delay_time, (uint16_t)1), x_y_axis_max_speed, x_y_axis_acceleration, x_y_axis_jerk);
     pinMode(X_Y_AXIS_MOTOR_EN, OUTPUT);
 
     digitalWrite(Z_AXIS_MOTOR_EN, LOW);
@@ -94,56 +227,157 @@ void motor_init() {
     digitalWrite(X_Y_AXIS_MOTOR_DIR, LOW);
 }
 
-void vl53_init() {
-    if(!Wire.begin()) {
-        return;
-    }
+/**
+ * @brief Mark the measurement of a sensor ready and wake the scanner task
+ *
+ * @param arg `void*`: the sensor
+ */
+static void IRAM_ATTR vl53_isr(void* arg) {
+    vl53_int_fired[(uintptr_t)arg] = true;
+    BaseType_t woken = pdFALSE;
+    if (scanner_task_handle != NULL) vTaskNotifyGiveFromISR(scanner_task_handle, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
 
+/**
+ * @brief Boot a sensor and start continuous ranging
+ *
+ * @param sensor `uint8_t`: the sensor
+ * @param address `uint8_t`: the I2C address the sensor moves to
+ * @return `bool`: `false` if the sensor did not answer
+ */
+bool vl53_begin(uint8_t sensor, uint8_t address) {
 #ifdef CONFIG_VL53L1X
-    Serial.println("Use VL53L1X");
-    if (!vl53.begin(0x29, &Wire)) {
-        ESP_LOGE(MODULE_TAG, "Failed to boot VL53L1X: ", vl53.vl_status);
-        vl53.end();
-        return;
+    Serial.printf("Use VL53L1X %u at 0x%02x\n", sensor, address);
+    if (!vl53[sensor].begin(address, &Wire)) {
+        ESP_LOGE(MODULE_TAG, "Failed to boot VL53L1X %u: %d", sensor, vl53[sensor].vl_status);
+        vl53[sensor].end();
+        return false;
     }
 
     uint32_t distance;
     uint8_t status;
-    vl53.VL53L1X_GetRangeStatus(&status);
+    vl53[sensor].VL53L1X_GetRangeStatus(&status);
 
-    if(vl53.GetDistance(&distance) != 0) {
-        vl53.clearInterrupt();
-        ESP_LOGE(MODULE_TAG, "Failed to get VL53L1X distance: ", vl53.vl_status);
-        vl53.stopRanging();
-        vl53.end();
-        return;
+    if(vl53[sensor].GetDistance(&distance) != 0) {
+        vl53[sensor].clearInterrupt();
+        ESP_LOGE(MODULE_TAG, "Failed to get VL53L1X %u distance: %d", sensor, vl53[sensor].vl_status);
+        vl53[sensor].stopRanging();
+        vl53[sensor].end();
+        return false;
     }
 
-    if (!vl53.startRanging()) {
-        ESP_LOGE(MODULE_TAG, "Failed to start VL53L1X ranging: ", vl53.vl_status);
-        vl53.stopRanging();
-        vl53.end();
-        return;
+    if (!vl53[sensor].startRanging()) {
+        ESP_LOGE(MODULE_TAG, "Failed to start VL53L1X %u ranging: %d", sensor, vl53[sensor].vl_status);
+        vl53[sensor].stopRanging();
+        vl53[sensor].end();
+        return false;
     }
 
-    vl53.setTimingBudget(vl53l1x_timeing_budget);
-    ESP_LOGD(MODULE_TAG, "VL53L1X Timing budget (ms): %u", vl53.getTimingBudget());
+    vl53[sensor].setTimingBudget(vl53l1x_timeing_budget);
+    ESP_LOGD(MODULE_TAG, "VL53L1X %u Timing budget (ms): %u", sensor, vl53[sensor].getTimingBudget());
+
+    if (!vl53l1x_read_polarity(&Wire, address, &vl53_polarity[sensor])) {
+        ESP_LOGE(MODULE_TAG, "Failed to read VL53L1X %u interrupt polarity", sensor);
+        vl53[sensor].stopRanging();
+        vl53[sensor].end();
+        return false;
+    }
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+    vl53[sensor].VL53L1X_SetROI(VL53_SPAD_ROWS, VL53_ZONE_ROWS);
+    vl53_set_zone(0);
+    ESP_LOGD(MODULE_TAG, "VL53L1X zones: %u of %u rows", VL53_ZONE_COUNT, VL53_ZONE_ROWS);
+#endif
 #else
-    Serial.println("Use VL53L0X");
-    if (!vl53.begin()) {
-        ESP_LOGE(MODULE_TAG, "Failed to boot VL53L0X");
-        return;
+    Serial.printf("Use VL53L0X %u at 0x%02x\n", sensor, address);
+    if (!vl53[sensor].begin(address)) {
+        ESP_LOGE(MODULE_TAG, "Failed to boot VL53L0X %u", sensor);
+        return false;
     }
 
-    vl53.setMeasurementTimingBudgetMicroSeconds(vl53l1x_timeing_budget * 1000);
-    if (!vl53.startRangeContinuous()) {
-        ESP_LOGE(MODULE_TAG, "Failed to start VL53L0X ranging");
-        vl53.stopRangeContinuous();
+    vl53[sensor].setMeasurementTimingBudgetMicroSeconds(vl53l1x_timeing_budget * 1000);
+    if (!vl53[sensor].startRangeContinuous()) {
+        ESP_LOGE(MODULE_TAG, "Failed to start VL53L0X %u ranging", sensor);
+        vl53[sensor].stopRangeContinuous();
+        return false;
+    }
+#endif
+    return true;
+}
+
+/**
+ * @brief Boot the sensors, several sensors get their own address one by one through their XSHUT pin
+ *
+ * All sensors range at the same time, each one wakes the scanner task from its own interrupt pin.
+ */
+void vl53_init() {
+    if(!Wire.begin()) {
         return;
     }
+#ifdef CONFIG_VL53L1X
+    Wire.setClock(VL53L1X_I2C_CLOCK_FAST);
+#endif
+
+    if (vl53_sensor_count == 1) {
+        vl53_sensor_ready[0] = vl53_begin(0, vl53_sensor_address(0));
+    } else {
+        // All in reset, then each one wakes up alone at the default address and moves away from it
+        for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+            if (vl53_sensors[i].xshut_pin == VL53_NO_PIN) continue;
+            pinMode(vl53_sensors[i].xshut_pin, OUTPUT);
+            digitalWrite(vl53_sensors[i].xshut_pin, LOW);
+        }
+        delay(10);
+        for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+            if (vl53_sensors[i].xshut_pin != VL53_NO_PIN) {
+                digitalWrite(vl53_sensors[i].xshut_pin, HIGH);
+                delay(10);
+            }
+            vl53_sensor_ready[i] = vl53_begin(i, vl53_sensor_address(i));
+        }
+    }
+
+    for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+        if (!vl53_sensor_ready[i]) continue;
+        if (vl53_sensors[i].int_pin == VL53_NO_PIN) {
+            vl53_polled = true;
+            continue;
+        }
+        pinMode(vl53_sensors[i].int_pin, INPUT_PULLUP);
+        vl53_int_fired[i] = false;
+        attachInterruptArg(digitalPinToInterrupt(vl53_sensors[i].int_pin), vl53_isr, (void*)(uintptr_t)i, VL53_INT_EDGE);
+#ifdef CONFIG_VL53L1X
+        // A measurement that finished before the interrupt was attached holds GPIO1 and would hide the next edge
+        vl53l1x_clear_interrupt(&Wire, vl53_sensor_address(i));
+#endif
+    }
+    vl53_ready = vl53_sensor_ready[0];
+
+#ifdef CONFIG_VL53L1X
+    vl53_i2c_clock_init();
+#endif
+}
+
+#ifdef CONFIG_VL53L1X
+/**
+ * @brief Run the bus at fast mode plus if every sensor still answers at it, the boot stays at fast mode
+ */
+void vl53_i2c_clock_init() {
+    Wire.setClock(VL53L1X_I2C_CLOCK_FAST_PLUS);
+    bool answered = true;
+    for (uint8_t i = 0; i < vl53_sensor_count && answered; i++) {
+        uint8_t polarity;
+        if (!vl53_sensor_ready[i]) continue;
+        answered = vl53l1x_read_polarity(&Wire, vl53_sensor_address(i), &polarity) && polarity == vl53_polarity[i];
+    }
+    vl53_i2c_clock = answered ? VL53L1X_I2C_CLOCK_FAST_PLUS : VL53L1X_I2C_CLOCK_FAST;
+    if (!answered) Wire.setClock(vl53_i2c_clock);
+    ESP_LOGI(MODULE_TAG, "VL53L1X I2C clock: %u kHz", vl53_i2c_clock / 1000);
+}
 #endif
-    vl53_ready = true;
 
+uint8_t vl53_sensor_address(uint8_t sensor) {
+    return vl53_sensor_count == 1 ? VL53_DEFAULT_ADDRESS : VL53_ADDRESS_BASE + sensor;
 }
 
 void module_init() {
@@ -154,185 +388,1312 @@ void module_init() {
     motor_init();
 
     vl53_init();
+
+    checkpoint_valid = get_checkpoint(&checkpoint, sizeof(checkpoint));
+    if (checkpoint_valid) {
+        ESP_LOGI(MODULE_TAG, "Checkpoint of %s at Z axis steps: %u, send resume to continue", checkpoint.name, checkpoint.z_steps);
+    }
+
+    command_queue = xQueueCreate(SCANNER_COMMAND_QUEUE_LENGTH, sizeof(scanner_command_t));
+    if (command_queue == NULL) {
+        ESP_LOGE(MODULE_TAG, "Failed to create the command queue");
+        return;
+    }
+    if (xTaskCreatePinnedToCore(scanner_task, "scanner", SCANNER_TASK_STACK_SIZE, NULL, SCANNER_TASK_PRIORITY, &scanner_task_handle, SCANNER_TASK_CORE) != pdPASS) {
+        ESP_LOGE(MODULE_TAG, "Failed to create the scanner task");
+    }
+}
+
+/**
+ * @brief Queue a command for the scanner task, safe to call from any task
+ *
+ * A stop also raises the abort flag and halts both motors at once, it does not wait for the queue. A stop that finds the
+ * queue full drops the commands before it, so the task always gets it and lowers the flag again.
+ *
+ * @param command `uint8_t`: `SCANNER_COMMAND_*`
+ * @param steps `uint32_t`: the steps of a jog, or the mode of `SCANNER_COMMAND_SET_MODE`
+ * @param name `const char*`: the project name of `SCANNER_COMMAND_SET_NAME`
+ */
+void queue_command(uint8_t command, uint32_t steps, const char* name = NULL) {
+    if (command == SCANNER_COMMAND_STOP) {
+        scanner_abort = true;
+        stepper_stop(STEPPER_AXIS_Z);
+        stepper_stop(STEPPER_AXIS_X_Y);
+    }
+
+    if (command_queue == NULL) {
+        ESP_LOGE(MODULE_TAG, "Command queue not ready, drop command: %u", command);
+        return;
+    }
+
+    scanner_command_t item;
+    item.command = command;
+    item.steps = steps;
+    item.name[0] = '\0';
+    if (name != NULL) {
+        strncpy(item.name, name, SCANNER_PROJECT_NAME_LENGTH - 1);
+        item.name[SCANNER_PROJECT_NAME_LENGTH - 1] = '\0';
+    }
+
+    if (xQueueSend(command_queue, &item, 0) != pdTRUE) {
+        if (command == SCANNER_COMMAND_STOP) {
+            ESP_LOGW(MODULE_TAG, "Command queue full, drop %u commands before the stop", uxQueueMessagesWaiting(command_queue));
+            xQueueReset(command_queue);
+            if (xQueueSend(command_queue, &item, 0) != pdTRUE) ESP_LOGE(MODULE_TAG, "Failed to queue the stop");
+        } else {
+            ESP_LOGW(MODULE_TAG, "Command queue full, drop command: %u", command);
+        }
+    }
+    // Cut a sensor wait short
+    if (scanner_task_handle != NULL) xTaskNotifyGive(scanner_task_handle);
 }
 
 void set_project_name(const char* name) {
-    Serial.printf("Set project name: %s\n", name);
-    project_name = name;
-    point_count = 0;
+    queue_command(SCANNER_COMMAND_SET_NAME, 0, name);
 }
 
 void set_command(uint8_t command, uint32_t steps) {
+    queue_command(command, steps);
+}
+
+void set_scan_mode(uint8_t mode) {
+    queue_command(SCANNER_COMMAND_SET_MODE, mode);
+}
+
+void set_estimator(uint8_t estimator) {
+    queue_command(SCANNER_COMMAND_SET_ESTIMATOR, estimator);
+}
+
+void set_fast_skip(uint16_t stride) {
+    queue_command(SCANNER_COMMAND_SET_SKIP, stride);
+}
+
+void apply_command(uint8_t command, uint32_t steps) {
     ESP_LOGI(MODULE_TAG, "Set command: %u, step: %u", command, steps);
     Serial.printf("Set command: %u, step: %u\n", command, steps);
+    stepper_stop(STEPPER_AXIS_Z);
+    stepper_stop(STEPPER_AXIS_X_Y);
+
     _command = command;
     _steps = steps;
+    motion_started = false;
+    scan_ring_start = true;
+    scan_state = SCAN_STATE_IDLE;
+    resume_state = RESUME_STATE_HOME;
 
     if (_command == SCANNER_COMMAND_START) {
         start_time = millis();
     }
+    // A finished scan is flushed before its stop, a stopped one leaves what it holds behind
+    if (_command == SCANNER_COMMAND_START || _command == SCANNER_COMMAND_STOP) scan_points_begin();
 
     x_y_steps = 0;
+    x_y_ring_move = x_y_axis_one_time_step;
+    skip_begin(&scan_skip, skip_stride);
 }
 
 uint32_t get_z_axis_counter() {
-    return z_steps;
+    return stepper_get_position(STEPPER_AXIS_Z);
+}
+
+void z_axis_move(bool direction, uint32_t steps) {
+    planner_move(STEPPER_AXIS_Z, direction == Z_AXIS_MOTOR_UP, steps);
+}
+
+void x_y_axis_move(bool direction, uint32_t steps) {
+    planner_move(STEPPER_AXIS_X_Y, direction, steps);
 }
 
-void z_axis_motor_step(bool direction) {
-    if ( ( z_steps >= z_axis_max && direction == Z_AXIS_MOTOR_UP ) || 
-         ( ( digitalRead(BUTTON_PIN) == LOW || z_steps <= 0 ) && direction == Z_AXIS_MOTOR_DOWN ) ) {
+/**
+ * @brief A sensor takes part in the scan
+ */
+bool scan_sensor_active(uint8_t sensor) {
+    return sensor == 0 || (sensor < vl53_sensor_count && vl53_sensor_ready[sensor]);
+}
 
-        ESP_LOGD(MODULE_TAG, "Z_AXIS_MOTOR_FULL_STEP: %u", z_steps);
+/**
+ * @brief Start collecting the samples of the next point
+ *
+ * @param sensor `uint8_t`: the sensor, default is `0`
+ */
+void scan_range_begin(uint8_t sensor = 0) {
+    scan_range_t* range = &scan_ranges[sensor];
+    uint16_t center = vl53_sensors[sensor].center;
+    estimator_begin(&range->estimator, scan_estimator, center > VL53_DISTANCE_WINDOW ? center - VL53_DISTANCE_WINDOW : 0, center + VL53_DISTANCE_WINDOW);
+    range->start_time = millis();
+    range->last_sample_time = range->start_time;
+    range->misses = 0;
+    range->done = false;
+}
+
+void scan_range_begin_all() {
+    for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+        if (scan_sensor_active(i)) scan_range_begin(i);
+    }
+}
+
+/**
+ * @brief Sleep until the sensor may have the next sample
+ *
+ * @param timeout_ms `uint32_t`: the longest sleep
+ */
+void scan_range_wait(uint32_t timeout_ms) {
+    if (vl53_ready) {
+        vl53_wait(vl53_polled ? min(timeout_ms, (uint32_t)VL53_WAIT_SLICE_MS) : timeout_ms);
+    } else {
+        delay(1);
+    }
+}
+
+/**
+ * @brief Enough samples for the point
+ *
+ * @param range `scan_range_t*`: the samples
+ * @param count `uint16_t`: the number of valid samples of a point
+ * @param adaptive `bool`: stop as soon as the distance is within `sample_bound`, between `sample_min` and `sample_max` samples
+ */
+bool scan_range_done(scan_range_t* range, uint16_t count, bool adaptive) {
+    uint16_t samples = estimator_count(&range->estimator);
+    if (!adaptive) return samples >= min(count, (uint16_t)ESTIMATOR_MAX_SAMPLES);
+    if (samples >= sample_max) return true;
+    return samples >= sample_min && estimator_confident(&range->estimator, sample_bound / 100.0f);
+}
+
+/**
+ * @brief Radius of the point from its samples, counted in the scan stats
+ *
+ * @param sensor `uint8_t`: the sensor
+ * @return `double`: the radius, `-1` if no sample was inside the distance window
+ */
+double scan_range_result(uint8_t sensor) {
+    scan_range_t* range = &scan_ranges[sensor];
+    scan_samples += estimator_count(&range->estimator);
+    scan_points++;
+    range->done = true;
+    range->r = -1;
+    if (estimator_count(&range->estimator) == 0) return -1;
+    range->r = fabs(double(vl53_sensors[sensor].center) - double(estimator_result(&range->estimator)));
+    return range->r;
+}
+
+/**
+ * @brief Take the next sample if one is ready, never blocks
+ *
+ * @param count `uint16_t`: the number of valid samples of a point
+ * @param r `double*`: the radius of the point, `-1` for no surface
+ * @param adaptive `bool`: end the point once the samples agree, see `scan_range_done`
+ * @param sensor `uint8_t`: the sensor, default is `0`
+ * @return `bool`: `true` when the point is complete
+ */
+bool scan_range_poll(uint16_t count, double* r, bool adaptive = false, uint8_t sensor = 0) {
+    scan_range_t* range = &scan_ranges[sensor];
+    if (!vl53_ready) {
+        if (millis() - range->start_time < 800) return false;
+        range->done = true;
+        range->r = 20;
+        *r = range->r;
+        return true;
+    }
+
+    uint16_t distance;
+    if (!vl53_read(sensor, &distance)) {
+        if (millis() - range->last_sample_time < vl53_timeout_ms()) return false;
+
+        // Give up on the point with the samples so far
+        vl53_timeout(sensor);
+        *r = scan_range_result(sensor);
+        return true;
+    }
+    range->last_sample_time = millis();
+    if (!estimator_add(&range->estimator, distance)) {
+        // Nothing in the window, give up once the budget is spent
+        if (++range->misses < SCAN_RANGE_MISS_BUDGET) return false;
+        *r = scan_range_result(sensor);
+        return true;
+    }
+    if (!scan_range_done(range, count, adaptive)) return false;
+
+    *r = scan_range_result(sensor);
+    return true;
+}
+
+/**
+ * @brief Take the next samples of every sensor, never blocks
+ *
+ * @param count `uint16_t`: the number of valid samples of a point
+ * @param adaptive `bool`: end a point once its samples agree
+ * @return `bool`: `true` when every sensor has its point, see `scan_range_t.r`
+ */
+bool scan_range_poll_all(uint16_t count, bool adaptive) {
+    bool done = true;
+    for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+        if (!scan_sensor_active(i) || scan_ranges[i].done) continue;
+        double r;
+        if (!scan_range_poll(count, &r, adaptive, i)) done = false;
+    }
+    return done;
+}
+
+uint8_t scan_sensors_ready() {
+    uint8_t ready = 0;
+    for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+        if (vl53_sensor_ready[i]) ready++;
+    }
+    return ready;
+}
+
+/**
+ * @brief Last Z axis position a scan rises to, so the highest sensor stays within `z_axis_max`
+ *
+ * Sensors mounted a part of the height apart each scan their part, which cuts the Z travel.
+ */
+uint32_t scan_z_end() {
+    int32_t top = 0;
+    for (uint8_t i = 1; i < vl53_sensor_count; i++) {
+        if (scan_sensor_active(i)) top = max(top, vl53_sensors[i].z_steps);
+    }
+    return top < z_axis_max ? z_axis_max - top : 1;
+}
+
+/**
+ * @brief Hand a point to the filter of its sensor, or straight on when the filter is off
+ *
+ * @param sensor `uint8_t`: the sensor
+ * @param z_steps `uint32_t`: the Z axis position of the point, or of the optical axis with several zones
+ * @param angle_steps `uint32_t`: the turntable position inside the turn
+ * @param r `double`: the radius in mm, `-1` for no surface
+ * @param flags `uint8_t`: `POINT_FLAG_*` of the scan mode
+ */
+void scan_push_point_at(uint8_t sensor, uint32_t z_steps, uint32_t angle_steps, double r, uint8_t flags) {
+    uint8_t channel = sensor;
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+    // Every zone sees the surface at its own height
+    if (vl53_ready && r >= 0) {
+        z_steps = max((int32_t)z_steps + vl53_zone_z_steps(vl53_zone, estimator_result(&scan_ranges[0].estimator)), (int32_t)0);
+    }
+    flags |= POINT_FLAG_ZONE;
+    channel = vl53_zone;
+#endif
+    scanner_point_t point;
+    point.time_ms = millis() - start_time;
+    point.z_steps = z_steps;
+    point.x_y_steps = angle_steps;
+    point.r = r < 0 ? 0 : (uint16_t)constrain(r * 100.0, 0.0, 65535.0);
+    point.flags = flags | (r < 0 ? POINT_FLAG_NO_SURFACE : 0);
+
+    if (!scan_filter_active()) {
+        scan_emit_point(&point);
         return;
     }
+    filter_t* filter = &scan_filters[channel];
+    if (!filter_push(filter, &filter_config, &point)) {
+        ESP_LOGW(MODULE_TAG, "Filter %u full", channel);
+        return;
+    }
+    while (filter_pop(filter, &filter_config, &point)) scan_emit_point(&point);
+}
+
+/**
+ * @brief Pass a judged point on, to the voxel grid when it is on
+ *
+ * @param point `scanner_point_t*`: the point
+ */
+void scan_emit_point(scanner_point_t* point) {
+    if (point->flags & POINT_FLAG_SUSPECT) {
+        filter_suspect_points++;
+        if (filter_config.drop) {
+            filter_dropped_points++;
+            return;
+        }
+    }
+    if (!scan_voxel_active()) {
+        scan_send_point(point);
+        return;
+    }
+
+    // A voxel is the mean of the surface it holds, suspect and no surface points stay out
+    if (point->flags & (POINT_FLAG_NO_SURFACE | POINT_FLAG_SUSPECT)) return;
+    voxel_input_points++;
+    if (!voxel_add(&scan_voxels, &voxel_config, point)) {
+        ESP_LOGW(MODULE_TAG, "Voxel grid full, sent early");
+        scan_voxel_flush(UINT32_MAX);
+        voxel_add(&scan_voxels, &voxel_config, point);
+    }
+}
+
+/**
+ * @brief Number a point and hand it to the stream task and the recording, never waits for the network
+ *
+ * @param point `scanner_point_t*`: the point, `seq` and the ring flag are set here
+ */
+void scan_send_point(scanner_point_t* point) {
+    if (scan_ring_start) {
+        point->flags |= POINT_FLAG_RING;
+        scan_ring_start = false;
+    }
+    point->seq = ++point_count;
+
+    // The SD card keeps every point, also the ones the network falls behind on
+    recorder_push(point);
+    if (!point_buffer_push(point)) {
+        ESP_LOGW(MODULE_TAG, "Point buffer full, dropped: %u", point_buffer_dropped());
+    }
+    stream_notify();
+}
+
+/**
+ * @brief The refine scan jumps between segments, its points have no neighbours on the ring to judge against
+ */
+bool scan_filter_active() {
+    return filter_config.window > 0 && scan_mode != SCAN_MODE_REFINE;
+}
+
+bool scan_voxel_active() {
+    return voxel_config.z_size > 0 && scan_mode != SCAN_MODE_REFINE;
+}
 
-    digitalWrite(Z_AXIS_MOTOR_DIR, direction);
+/**
+ * @brief Send the voxels of the Z bands below `z_floor`, each band as a ring of its own
+ *
+ * @param z_floor `uint32_t`: no point below this Z axis position is still to come, `UINT32_MAX` for all voxels
+ */
+void scan_voxel_flush(uint32_t z_floor) {
+    scanner_point_t point;
+    bool band_start;
+    while (voxel_pop(&scan_voxels, &voxel_config, z_floor, &point, &band_start)) {
+        if (band_start) scan_ring_start = true;
+        scan_send_point(&point);
+    }
+}
+
+/**
+ * @brief Lowest Z axis position a point of the next rings can have, the Z axis only rises
+ *
+ * A zone below the optical axis puts its points lower the farther the surface, down to the far end of the distance window.
+ */
+uint32_t scan_voxel_floor() {
+    int32_t lowest = 0;
+    for (uint8_t i = 1; i < vl53_sensor_count; i++) {
+        if (scan_sensor_active(i)) lowest = min(lowest, vl53_sensors[i].z_steps);
+    }
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+    for (uint8_t zone = 0; zone < VL53_ZONE_COUNT; zone++) {
+        lowest = min(lowest, vl53_zone_z_steps(zone, vl53_sensors[0].center + VL53_DISTANCE_WINDOW));
+    }
+#endif
+    return max((int32_t)get_z_axis_counter() + lowest + 1, (int32_t)0);
+}
 
-    digitalWrite(Z_AXIS_MOTOR_STEP, HIGH);
-    delayMicroseconds(z_axis_delay_time);
-    digitalWrite(Z_AXIS_MOTOR_STEP, LOW);
-    delayMicroseconds(z_axis_delay_time);
+/**
+ * @brief End of a ring or of the scan: hand out the points the filters still hold and the finished voxels, then send the batch
+ *
+ * @param last `bool`: the scan ended, every voxel is sent
+ */
+void scan_flush(bool last) {
+    if (scan_filter_active()) {
+        scanner_point_t point;
+        for (uint8_t i = 0; i < SCAN_FILTER_COUNT; i++) {
+            filter_end_ring(&scan_filters[i]);
+            while (filter_pop(&scan_filters[i], &filter_config, &point)) scan_emit_point(&point);
+        }
+    }
+    if (scan_voxel_active()) scan_voxel_flush(last ? UINT32_MAX : scan_voxel_floor());
+    stream_flush();
+}
 
-    if (direction == Z_AXIS_MOTOR_UP) {
-        z_steps++;
+/**
+ * @brief Start or stop a scan: drop the points the filters and the voxel grid hold, so nothing of one scan is judged
+ * against or sent with the next
+ */
+void scan_points_begin() {
+    for (uint8_t i = 0; i < SCAN_FILTER_COUNT; i++) filter_begin(&scan_filters[i]);
+    voxel_begin(&scan_voxels);
+}
+
+/**
+ * @brief Push the point of a sensor where the sensor is mounted
+ *
+ * @param sensor `uint8_t`: the sensor
+ * @param z_steps `uint32_t`: the Z axis position of sensor 0
+ * @param angle_steps `uint32_t`: the turntable position inside the turn of sensor 0
+ * @param r `double`: the radius in mm, `-1` for no surface
+ * @param flags `uint8_t`: `POINT_FLAG_*` of the scan mode
+ */
+void scan_push_sensor_point(uint8_t sensor, uint32_t z_steps, uint32_t angle_steps, double r, uint8_t flags = 0) {
+    if (vl53_sensor_count > 1) {
+        const vl53_sensor_t* mount = &vl53_sensors[sensor];
+        int32_t angle = ((int32_t)angle_steps + mount->angle_steps) % (int32_t)x_y_axis_max;
+        angle_steps = angle < 0 ? angle + x_y_axis_max : angle;
+        z_steps = max((int32_t)z_steps + mount->z_steps, (int32_t)0);
+        flags |= POINT_FLAG_SENSOR;
+    }
+    scan_push_point_at(sensor, z_steps, angle_steps, r, flags);
+}
+
+void scan_push_point(uint32_t angle_steps, double r, uint8_t flags = 0) {
+    scan_push_sensor_point(0, get_z_axis_counter(), angle_steps, r, flags);
+}
+
+/**
+ * @brief Push the finished points of the sensors that are not sensor 0
+ */
+void scan_push_other_points(uint32_t angle_steps) {
+    for (uint8_t i = 1; i < vl53_sensor_count; i++) {
+        if (scan_sensor_active(i)) scan_push_sensor_point(i, get_z_axis_counter(), angle_steps, scan_ranges[i].r);
+    }
+}
+
+/**
+ * @brief Sensor time the adaptive sampling saved against `x_y_axis_check_times` samples for every point
+ *
+ * @return `int32_t`: the time in ms, negative if the noisy points took more samples
+ */
+int32_t scan_time_saved_ms() {
+    int64_t fixed = (int64_t)scan_points * x_y_axis_check_times;
+    return (fixed - (int64_t)scan_samples) * vl53l1x_timeing_budget;
+}
+
+/**
+ * @brief Save the progress at the end of a ring, at most every `CHECKPOINT_INTERVAL_MS`
+ *
+ * The recording reaches the card first, so a resume never skips rings it did not keep.
+ *
+ * @param next_z_steps `uint32_t`: the Z axis position of the next ring
+ */
+void scan_checkpoint(uint32_t next_z_steps) {
+    if (millis() - last_checkpoint_time < CHECKPOINT_INTERVAL_MS) return;
+    if (!recorder_flush()) {
+        ESP_LOGW(MODULE_TAG, "Recording not on the card, no checkpoint at Z axis steps: %u", next_z_steps);
+        return;
+    }
+    last_checkpoint_time = millis();
+
+    strncpy(checkpoint.name, project_name.c_str(), SCANNER_PROJECT_NAME_LENGTH - 1);
+    checkpoint.name[SCANNER_PROJECT_NAME_LENGTH - 1] = '\0';
+    checkpoint.z_steps = next_z_steps;
+    checkpoint.point_count = point_count;
+    checkpoint.mode = scan_mode;
+    checkpoint.estimator = scan_estimator;
+    checkpoint.skip_stride = skip_stride;
+    set_checkpoint(&checkpoint, sizeof(checkpoint));
+    checkpoint_valid = true;
+    ESP_LOGD(MODULE_TAG, "Checkpoint at Z axis steps: %u, points: %u", next_z_steps, checkpoint.point_count);
+}
+
+void scan_clear_checkpoint() {
+    if (!checkpoint_valid) return;
+    clear_checkpoint();
+    checkpoint_valid = false;
+}
+
+void scan_finish() {
+    ESP_LOGD(MODULE_TAG, "Z Full step max count and Finish");
+    project_name = "";
+    scan_flush(true);
+    recorder_stop();
+    scan_clear_checkpoint();
+    apply_command(SCANNER_COMMAND_STOP, 0);
+}
+
+/**
+ * @brief Move on to the next point of the step scan, or to the next ring
+ *
+ * With several zones a ring moves on by `VL53_ZONE_COUNT` zone pitches at the center distance, so the lowest zone lands
+ * one pitch above the highest zone of the ring before.
+ */
+void scan_step_next() {
+    uint32_t advance = x_y_axis_one_time_step * skip_points(&scan_skip);
+    if (x_y_steps + advance >= x_y_axis_max) {
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+        uint32_t z_move = vl53_ring_z_steps;
+#else
+        uint32_t z_move = z_axis_one_time_step;
+#endif
+        ESP_LOGD(MODULE_TAG, "X Y Full step max count, Z axis steps: %u", get_z_axis_counter());
+        scan_flush();
+        // A stride may end the ring early, the first move of the next ring makes up for it
+        x_y_ring_move = scan_skip.active ? x_y_axis_max - x_y_steps : x_y_axis_one_time_step;
+        x_y_steps = 0;
+        skip_begin(&scan_skip, skip_stride);
+        scan_ring_start = true;
+        scan_checkpoint(get_z_axis_counter() + z_move);
+        z_axis_move(Z_AXIS_MOTOR_UP, z_move);
+        scan_state = SCAN_STATE_Z_MOVE;
     } else {
-        z_steps--;
+        x_y_steps += advance;
+        x_y_axis_move(HIGH, advance);
+        scan_state = SCAN_STATE_MOVE;
     }
 }
 
-void x_y_axis_motor_step(bool direction) {
-    digitalWrite(X_Y_AXIS_MOTOR_DIR, direction);
+/**
+ * @brief Stop and go scan: move, sample, then push the point and start the next move
+ */
+void scan_step_loop() {
+    double r = 0;
+    uint16_t back = 0;
+
+    switch (scan_state) {
+        case SCAN_STATE_IDLE:
+            x_y_axis_move(HIGH, x_y_axis_one_time_step);
+            scan_state = SCAN_STATE_MOVE;
+            break;
+        case SCAN_STATE_MOVE:
+            if (stepper_is_busy(STEPPER_AXIS_X_Y)) {
+                delay(1);
+                break;
+            }
+            scan_range_begin_all();
+            scan_state = SCAN_STATE_RANGE;
+            break;
+        case SCAN_STATE_RANGE:
+            if (!scan_range_poll_all(x_y_axis_check_times, sample_bound > 0)) {
+                scan_range_wait(vl53_timeout_ms());
+                break;
+            }
+            // The fast skip follows sensor 0, the other sensors take their points where it stops
+            r = scan_ranges[0].r;
+            back = skip_check(&scan_skip, x_y_steps, r >= 0);
+            if (back > 0) {
+                // The surface came back inside the last stride, scan that stride again point by point
+                x_y_steps -= (uint32_t)x_y_axis_one_time_step * back;
+                x_y_axis_move(LOW, (uint32_t)x_y_axis_one_time_step * back);
+                scan_state = SCAN_STATE_MOVE;
+                break;
+            }
+            scan_push_point(x_y_steps, r);
+            scan_push_other_points(x_y_steps);
 
-    digitalWrite(X_Y_AXIS_MOTOR_STEP, HIGH);
-    delayMicroseconds(x_y_axis_step_delay_time);
-    digitalWrite(X_Y_AXIS_MOTOR_STEP, LOW);
-    delayMicroseconds(x_y_axis_step_delay_time);
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+            if (vl53_ready) {
+                // The fast skip follows the lowest zone, the others are taken at every point it keeps
+                vl53_set_zone(1);
+                scan_range_begin();
+                scan_state = SCAN_STATE_ZONE;
+                break;
+            }
+#endif
+            scan_step_next();
+            break;
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+        case SCAN_STATE_ZONE:
+            if (!scan_range_poll(x_y_axis_check_times, &r, sample_bound > 0)) {
+                scan_range_wait(vl53_timeout_ms());
+                break;
+            }
+            scan_push_point(x_y_steps, r);
+            if (vl53_zone + 1 < VL53_ZONE_COUNT) {
+                vl53_set_zone(vl53_zone + 1);
+                scan_range_begin();
+                break;
+            }
+            vl53_set_zone(0);
+            scan_step_next();
+            break;
+#endif
+        case SCAN_STATE_Z_MOVE:
+            if (stepper_is_busy(STEPPER_AXIS_Z)) {
+                delay(1);
+                break;
+            }
+            if (get_z_axis_counter() >= scan_z_end()) {
+                scan_finish();
+                break;
+            }
+            x_y_axis_move(HIGH, x_y_ring_move);
+            scan_state = SCAN_STATE_MOVE;
+            break;
+    }
+}
+
+/**
+ * @brief Continuous scan: the turntable turns a full ring at a constant rate while the sensor ranges
+ *
+ * The rate is one `x_y_axis_one_time_step` per point, a point is placed at the middle of its samples.
+ */
+void scan_continuous_loop() {
+    double r = 0;
+
+    switch (scan_state) {
+        case SCAN_STATE_IDLE: {
+            uint32_t point_time_us = (uint32_t)vl53l1x_timeing_budget * 1000 * max(x_y_axis_check_times, (uint16_t)1);
+            ring_start_position = stepper_get_position(STEPPER_AXIS_X_Y);
+            stepper_move(STEPPER_AXIS_X_Y, HIGH, x_y_axis_max, point_time_us / (2 * max(x_y_axis_one_time_step, (uint16_t)1)));
+            scan_range_begin_all();
+            scan_state = SCAN_STATE_MOVE;
+            break;
+        }
+        case SCAN_STATE_MOVE: {
+            // Each sensor ranges on its own, a point is pushed as soon as its sensor has it
+            bool pushed = false;
+            for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+                if (!scan_sensor_active(i) || !scan_range_poll(x_y_axis_check_times, &r, false, i)) continue;
+                int32_t angle_steps = stepper_get_position(STEPPER_AXIS_X_Y) - ring_start_position - x_y_axis_one_time_step / 2;
+                scan_push_sensor_point(i, get_z_axis_counter(), max(angle_steps, (int32_t)0), r);
+                scan_range_begin(i);
+                pushed = true;
+            }
+            if (!pushed) scan_range_wait(VL53_WAIT_SLICE_MS);
+
+            if (!stepper_is_busy(STEPPER_AXIS_X_Y)) {
+                ESP_LOGD(MODULE_TAG, "Ring done, Z axis steps: %u", get_z_axis_counter());
+                scan_flush();
+                scan_ring_start = true;
+                scan_checkpoint(get_z_axis_counter() + z_axis_one_time_step);
+                z_axis_move(Z_AXIS_MOTOR_UP, z_axis_one_time_step);
+                scan_state = SCAN_STATE_Z_MOVE;
+            }
+            break;
+        }
+        case SCAN_STATE_Z_MOVE:
+            if (stepper_is_busy(STEPPER_AXIS_Z)) {
+                delay(1);
+                break;
+            }
+            if (get_z_axis_counter() >= scan_z_end()) {
+                scan_finish();
+                break;
+            }
+            scan_state = SCAN_STATE_IDLE;
+            break;
+    }
+}
+
+/**
+ * @brief Turntable position inside the turn of the refine scan
+ *
+ * @return `uint32_t`: the steps from the first coarse angle, `0` to `x_y_axis_max - 1`
+ */
+uint32_t refine_x_y_angle() {
+    int32_t angle = (stepper_get_position(STEPPER_AXIS_X_Y) - refine_x_y_origin) % (int32_t)x_y_axis_max;
+    return angle < 0 ? angle + x_y_axis_max : angle;
+}
+
+bool refine_is_detail(uint16_t band, uint16_t segment) {
+    return refine_detail[band][segment / 8] & (1 << (segment % 8));
+}
+
+void refine_set_detail(uint16_t band, uint16_t segment) {
+    segment %= refine_segments;
+    refine_detail[band][segment / 8] |= 1 << (segment % 8);
+}
+
+/**
+ * @brief The radii differ by more than `REFINE_EDGE`, or only one of them saw the surface
+ */
+bool refine_is_edge(uint16_t a, uint16_t b) {
+    if (a == REFINE_NO_SURFACE || b == REFINE_NO_SURFACE) return a != b;
+    return abs((int32_t)a - (int32_t)b) > REFINE_EDGE;
+}
+
+/**
+ * @brief Find the segments of the band below the finished coarse ring that need the fine pass
+ *
+ * A segment spans from one coarse angle to the next. It is marked for a radius step along either
+ * ring, a step from the lower to the upper ring, or a bend of the upper ring at one of its ends.
+ *
+ * @param band `uint16_t`: the band between coarse ring `band` and `band + 1`
+ */
+void refine_mark_band(uint16_t band) {
+    const uint16_t* lower = refine_radius[refine_current ^ 1];
+    const uint16_t* upper = refine_radius[refine_current];
+    uint16_t marked = 0;
+
+    for (uint16_t s = 0; s < refine_segments; s++) {
+        uint16_t next = (s + 1) % refine_segments;
+        uint16_t prev = (s + refine_segments - 1) % refine_segments;
+        bool edge = refine_is_edge(lower[s], lower[next]) || refine_is_edge(upper[s], upper[next]) ||
+                    refine_is_edge(lower[s], upper[s]) || refine_is_edge(lower[next], upper[next]);
+        if (!edge && upper[prev] != REFINE_NO_SURFACE && upper[s] != REFINE_NO_SURFACE && upper[next] != REFINE_NO_SURFACE) {
+            // Curvature, the second difference of the radius
+            edge = abs((int32_t)upper[prev] - 2 * (int32_t)upper[s] + (int32_t)upper[next]) > REFINE_EDGE;
+        }
+        if (edge) {
+            refine_set_detail(band, s);
+            marked++;
+        }
+    }
+    ESP_LOGD(MODULE_TAG, "Band %u, detail segments: %u of %u", band, marked, refine_segments);
+}
+
+/**
+ * @brief Plan the coarse pass from the Z axis position, scaled so the detail map fits
+ *
+ * @return `bool`: `false` if the Z axis is already at the top
+ */
+bool refine_begin() {
+    refine_z_origin = get_z_axis_counter();
+    refine_x_y_origin = stepper_get_position(STEPPER_AXIS_X_Y);
+    if (refine_z_origin >= scan_z_end()) return false;
+
+    uint32_t z_travel = scan_z_end() - refine_z_origin;
+    uint32_t z_step = max(z_axis_one_time_step, (uint16_t)1);
+    uint32_t x_y_step = max(x_y_axis_one_time_step, (uint16_t)1);
+    uint32_t z_factor = max((uint32_t)REFINE_COARSE_FACTOR, (z_travel + z_step * REFINE_MAX_BANDS - 1) / (z_step * REFINE_MAX_BANDS));
+    uint32_t x_y_factor = max((uint32_t)REFINE_COARSE_FACTOR, ((uint32_t)x_y_axis_max + x_y_step * REFINE_MAX_SEGMENTS - 1) / (x_y_step * REFINE_MAX_SEGMENTS));
+
+    refine_z_stride = z_step * z_factor;
+    refine_x_y_stride = x_y_step * x_y_factor;
+    refine_rings = (z_travel + refine_z_stride - 1) / refine_z_stride;
+    refine_segments = (x_y_axis_max + refine_x_y_stride - 1) / refine_x_y_stride;
+
+    memset(refine_detail, 0, sizeof(refine_detail));
+    refine_current = 0;
+    refine_pass = REFINE_PASS_COARSE;
+    refine_ring = 0;
+    refine_segment = 0;
+    refine_fine_points = 0;
+    ESP_LOGI(MODULE_TAG, "Refine scan, coarse rings: %u, segments: %u", refine_rings, refine_segments);
+    return true;
+}
+
+/**
+ * @brief Target of the current point of the refine scan
+ *
+ * @param z_steps `uint32_t*`: the Z axis position
+ * @param angle `uint32_t*`: the turntable position inside the turn
+ */
+void refine_target(uint32_t* z_steps, uint32_t* angle) {
+    *z_steps = refine_z_origin + refine_ring * refine_z_stride;
+    *angle = refine_segment * refine_x_y_stride;
+    if (refine_pass == REFINE_PASS_FINE) {
+        *z_steps += refine_sub * z_axis_one_time_step;
+        *angle += refine_index * x_y_axis_one_time_step;
+    }
+}
+
+bool refine_fine_valid() {
+    uint32_t z_steps, angle;
+    refine_target(&z_steps, &angle);
+    if (!refine_is_detail(refine_ring, refine_segment)) return false;
+    // The coarse pass already has the points of the lower ring at the coarse angles
+    if (refine_sub == 0 && refine_index == 0) return false;
+    return z_steps < scan_z_end() && angle < x_y_axis_max;
+}
+
+/**
+ * @brief Step the fine pass cursor, bands and their rings top down, angles along the turn
+ *
+ * @return `bool`: `false` past the last point
+ */
+bool refine_fine_step() {
+    if (++refine_index < refine_x_y_stride / max(x_y_axis_one_time_step, (uint16_t)1)) return true;
+    refine_index = 0;
+    if (++refine_segment < refine_segments) return true;
+    refine_segment = 0;
+    if (refine_sub > 0) {
+        refine_sub--;
+        return true;
+    }
+    if (refine_ring == 0) return false;
+    refine_ring--;
+    refine_sub = refine_z_stride / max(z_axis_one_time_step, (uint16_t)1) - 1;
+    return true;
+}
+
+/**
+ * @brief Move the cursor to the next point of the refine scan
+ *
+ * @return `bool`: `false` once the fine pass is done
+ */
+bool refine_next() {
+    if (refine_pass == REFINE_PASS_COARSE) {
+        if (++refine_segment < refine_segments) return true;
+        if (refine_ring > 0) refine_mark_band(refine_ring - 1);
+        refine_current ^= 1;
+        refine_segment = 0;
+        if (++refine_ring < refine_rings) return true;
+
+        // The bands below the top ring, from the top, so the Z axis turns around once
+        if (refine_rings < 2) return false;
+        ESP_LOGI(MODULE_TAG, "Coarse pass done, points: %u", point_count);
+        refine_pass = REFINE_PASS_FINE;
+        refine_ring = refine_rings - 2;
+        refine_sub = refine_z_stride / max(z_axis_one_time_step, (uint16_t)1) - 1;
+        refine_segment = 0;
+        refine_index = 0;
+        if (refine_fine_valid()) return true;
+    }
+
+    while (refine_fine_step()) {
+        if (refine_fine_valid()) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Coarse to fine scan: a coarse pass up, then a fine pass down over the segments with detail
+ *
+ * The coarse pass takes every `REFINE_COARSE_FACTOR` ring and angle. The fine pass fills in the rings
+ * and angles of the marked segments, the turntable only turns forward and the Z axis only moves down.
+ * Points of the fine pass carry `POINT_FLAG_FINE`.
+ */
+void scan_refine_loop() {
+    double r = 0;
+    uint32_t z_steps, angle;
+
+    switch (scan_state) {
+        case SCAN_STATE_IDLE:
+            if (!motion_started) {
+                motion_started = true;
+                if (!refine_begin()) {
+                    scan_finish();
+                    break;
+                }
+            }
+            refine_target(&z_steps, &angle);
+            if (z_steps != get_z_axis_counter()) {
+                scan_flush();
+                scan_ring_start = true;
+                uint32_t current = get_z_axis_counter();
+                if (z_steps > current) {
+                    z_axis_move(Z_AXIS_MOTOR_UP, z_steps - current);
+                } else {
+                    z_axis_move(Z_AXIS_MOTOR_DOWN, current - z_steps);
+                }
+                scan_state = SCAN_STATE_Z_MOVE;
+                break;
+            }
+            [[fallthrough]];
+        case SCAN_STATE_Z_MOVE:
+            if (stepper_is_busy(STEPPER_AXIS_Z)) {
+                delay(1);
+                break;
+            }
+            refine_target(&z_steps, &angle);
+            {
+                uint32_t forward = (angle + x_y_axis_max - refine_x_y_angle()) % x_y_axis_max;
+                if (forward > 0) x_y_axis_move(HIGH, forward);
+            }
+            scan_state = SCAN_STATE_MOVE;
+            break;
+        case SCAN_STATE_MOVE:
+            if (stepper_is_busy(STEPPER_AXIS_X_Y)) {
+                delay(1);
+                break;
+            }
+            scan_range_begin();
+            scan_state = SCAN_STATE_RANGE;
+            break;
+        case SCAN_STATE_RANGE:
+            if (!scan_range_poll(x_y_axis_check_times, &r, sample_bound > 0)) {
+                scan_range_wait(vl53_timeout_ms());
+                break;
+            }
+            refine_target(&z_steps, &angle);
+            if (refine_pass == REFINE_PASS_COARSE) {
+                refine_radius[refine_current][refine_segment] = r < 0 ? REFINE_NO_SURFACE : (uint16_t)constrain(r * 100.0, 0.0, 65534.0);
+                scan_push_point(angle, r);
+            } else {
+                refine_fine_points++;
+                scan_push_point(angle, r, POINT_FLAG_FINE);
+            }
+
+            if (!refine_next()) {
+                ESP_LOGI(MODULE_TAG, "Refine scan done, fine points: %u", refine_fine_points);
+                scan_finish();
+                break;
+            }
+            scan_state = SCAN_STATE_IDLE;
+            break;
+    }
+}
+
+/**
+ * @brief Helical scan: the Z axis rises `z_axis_one_time_step` per turn while the turntable keeps turning
+ *
+ * Both axes get one constant rate move for the whole scan, so neither stops at the end of a ring.
+ * The height of a point is interpolated from the turntable travel at the middle of its samples.
+ */
+void scan_helical_loop() {
+    double r = 0;
+
+    switch (scan_state) {
+        case SCAN_STATE_IDLE: {
+            helix_z_origin = get_z_axis_counter();
+            if (helix_z_origin >= scan_z_end()) {
+                scan_finish();
+                break;
+            }
+            uint32_t z_step = max(z_axis_one_time_step, (uint16_t)1);
+            uint32_t z_travel = scan_z_end() - helix_z_origin;
+            uint32_t turns = (z_travel + z_step - 1) / z_step;
+            uint32_t point_time_us = (uint32_t)vl53l1x_timeing_budget * 1000 * max(x_y_axis_check_times, (uint16_t)1);
+            uint32_t x_y_half_period_us = point_time_us / (2 * max(x_y_axis_one_time_step, (uint16_t)1));
+            // The Z rate is rounded to whole microseconds, the drift of a full scan stays below one step per turn
+            uint32_t z_half_period_us = ((uint64_t)x_y_half_period_us * x_y_axis_max + z_step / 2) / z_step;
+
+            ESP_LOGI(MODULE_TAG, "Helix from Z axis steps: %u, turns: %u", helix_z_origin, turns);
+            ring_start_position = stepper_get_position(STEPPER_AXIS_X_Y);
+            helix_turn = 0;
+            stepper_move(STEPPER_AXIS_X_Y, HIGH, turns * x_y_axis_max, x_y_half_period_us);
+            stepper_move(STEPPER_AXIS_Z, true, z_travel, z_half_period_us);
+            scan_range_begin_all();
+            scan_state = SCAN_STATE_MOVE;
+            break;
+        }
+        case SCAN_STATE_MOVE: {
+            if (!stepper_is_busy(STEPPER_AXIS_Z)) {
+                ESP_LOGD(MODULE_TAG, "Helix done, Z axis steps: %u", get_z_axis_counter());
+                stepper_stop(STEPPER_AXIS_X_Y);
+                scan_finish();
+                break;
+            }
+
+            int32_t travel = stepper_get_position(STEPPER_AXIS_X_Y) - ring_start_position;
+            if (travel >= 0 && (uint32_t)travel / x_y_axis_max > helix_turn) {
+                helix_turn = travel / x_y_axis_max;
+                ESP_LOGD(MODULE_TAG, "Helix turn: %u, Z axis steps: %u", helix_turn, get_z_axis_counter());
+                scan_flush();
+                scan_ring_start = true;
+                scan_checkpoint(helix_z_origin + helix_turn * z_axis_one_time_step);
+            }
+
+            bool pushed = false;
+            for (uint8_t i = 0; i < vl53_sensor_count; i++) {
+                if (!scan_sensor_active(i) || !scan_range_poll(x_y_axis_check_times, &r, false, i)) continue;
+                int32_t middle = max(travel - x_y_axis_one_time_step / 2, (int32_t)0);
+                uint32_t z_steps = helix_z_origin + (uint32_t)((uint64_t)middle * z_axis_one_time_step / x_y_axis_max);
+                scan_push_sensor_point(i, min(z_steps, (uint32_t)scan_z_end()), middle % x_y_axis_max, r, POINT_FLAG_HELIX);
+                scan_range_begin(i);
+                pushed = true;
+            }
+            if (!pushed) scan_range_wait(VL53_WAIT_SLICE_MS);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Home, rise to the ring of the checkpoint, then scan on with the settings of the checkpoint
+ *
+ * The turntable has no home switch, so the resumed rings start at the angle it stands at.
+ */
+void scan_resume_loop() {
+    switch (resume_state) {
+        case RESUME_STATE_HOME:
+            if (!get_checkpoint(&checkpoint, sizeof(checkpoint))) {
+                ESP_LOGW(MODULE_TAG, "No checkpoint to resume");
+                apply_command(SCANNER_COMMAND_STOP, 0);
+                break;
+            }
+            ESP_LOGI(MODULE_TAG, "Resume %s at Z axis steps: %u", checkpoint.name, checkpoint.z_steps);
+            stepper_set_position(STEPPER_AXIS_Z, z_axis_max);
+            z_axis_move(Z_AXIS_MOTOR_DOWN, z_axis_max);
+            resume_state = RESUME_STATE_HOMING;
+            break;
+        case RESUME_STATE_HOMING:
+            if (stepper_is_busy(STEPPER_AXIS_Z)) {
+                delay(1);
+                break;
+            }
+            stepper_set_position(STEPPER_AXIS_Z, 0);
+            z_axis_move(Z_AXIS_MOTOR_UP, checkpoint.z_steps);
+            resume_state = RESUME_STATE_RISING;
+            break;
+        case RESUME_STATE_RISING:
+            if (stepper_is_busy(STEPPER_AXIS_Z)) {
+                delay(1);
+                break;
+            }
+            project_name = checkpoint.name;
+            point_count = checkpoint.point_count;
+            scan_mode = checkpoint.mode;
+            scan_estimator = checkpoint.estimator;
+            skip_stride = checkpoint.skip_stride;
+            scan_samples = 0;
+            scan_points = 0;
+            filter_suspect_points = 0;
+            filter_dropped_points = 0;
+            voxel_input_points = 0;
+            stream_set_name(checkpoint.name);
+            point_buffer_reset_stats();
+            recorder_resume(checkpoint.name, checkpoint.point_count);
+            last_checkpoint_time = millis();
+            scan_points_begin();
+            apply_command(SCANNER_COMMAND_START, 0);
+            break;
+    }
+}
+
+/**
+ * @brief Apply queued commands, then advance the scanner
+ *
+ * While stopped the queue wait paces the status broadcast, so a new command is picked up at once.
+ */
+void scanner_task(void* parameter) {
+    scanner_command_t item;
+
+    for (;;) {
+        TickType_t wait = _command == SCANNER_COMMAND_STOP ? pdMS_TO_TICKS(stream_get_policy().status_time) : 0;
+        while (xQueueReceive(command_queue, &item, wait) == pdTRUE) {
+            wait = 0;
+            if (item.command == SCANNER_COMMAND_SET_NAME) {
+                Serial.printf("Set project name: %s\n", item.name);
+                project_name = item.name;
+                point_count = 0;
+                scan_samples = 0;
+                scan_points = 0;
+                filter_suspect_points = 0;
+                filter_dropped_points = 0;
+                voxel_input_points = 0;
+                scan_points_begin();
+                stream_set_name(item.name);
+                point_buffer_reset_stats();
+                scan_clear_checkpoint();
+                last_checkpoint_time = millis();
+                if (item.name[0] != '\0') {
+                    recorder_start(item.name);
+                } else {
+                    recorder_stop();
+                }
+            } else if (item.command == SCANNER_COMMAND_SET_MODE) {
+                ESP_LOGI(MODULE_TAG, "Set scan mode: %u", item.steps);
+                scan_mode = item.steps;
+            } else if (item.command == SCANNER_COMMAND_SET_ESTIMATOR) {
+                ESP_LOGI(MODULE_TAG, "Set estimator: %u", item.steps);
+                scan_estimator = item.steps;
+            } else if (item.command == SCANNER_COMMAND_SET_SKIP) {
+                ESP_LOGI(MODULE_TAG, "Set fast skip stride: %u", item.steps);
+                skip_stride = item.steps;
+            } else {
+                if (item.command == SCANNER_COMMAND_STOP) scanner_abort = false;
+                apply_command(item.command, item.steps);
+            }
+        }
+
+        // A stop is on its way, the halted motors are not done with their moves
+        if (!scanner_abort) scanner_loop();
+    }
 }
 
 void scanner_loop() {
     if (_command == SCANNER_COMMAND_STOP) {
-        if (millis() - last_send_data_time > SEND_DATA_TIME_MS) {
+        if (millis() - last_send_data_time > stream_get_policy().status_time) {
             last_send_data_time = millis();
-            String send_msg =   "{\"z_steps\":" + String(z_steps) + 
+            recorder_stats_t sd = recorder_get_stats();
+            String send_msg =   "{\"z_steps\":" + String(get_z_axis_counter()) + 
                                 ",\"vl53l1x\":" + String(get_distance()) + 
+                                ",\"high_water_mark\":" + String(point_buffer_high_water_mark()) +
+                                ",\"dropped\":" + String(point_buffer_dropped()) +
+                                ",\"timeouts\":" + String(vl53_timeouts) +
+                                ",\"samples_per_point\":" + String(scan_points > 0 ? (double)scan_samples / scan_points : 0.0) +
+                                ",\"time_saved\":" + String(scan_time_saved_ms() / 1000.0) +
+                                ",\"fine_points\":" + String(refine_fine_points) +
+                                ",\"filter_suspect\":" + String(filter_suspect_points) +
+                                ",\"filter_dropped\":" + String(filter_dropped_points) +
+                                ",\"voxel_points\":" + String(voxel_input_points) +
+                                ",\"sensors\":" + String(scan_sensors_ready()) +
+#ifdef CONFIG_VL53L1X
+                                ",\"signal\":" + String(vl53_results[0].signal_rate) +
+                                ",\"ambient\":" + String(vl53_results[0].ambient_rate) +
+                                ",\"i2c_khz\":" + String(vl53_i2c_clock / 1000) +
+                                ",\"i2c_per_sample\":" + String(vl53_reads > 0 ? (double)vl53_reads_transactions / vl53_reads : 0.0) +
+#endif
+                                ",\"sd\":" + String(recorder_ready() ? "true" : "false") +
+                                ",\"sd_records\":" + String(sd.records) +
+                                ",\"sd_dropped\":" + String(sd.dropped) +
+                                ",\"sd_kbps\":" + String(sd.write_us > 0 ? sd.bytes * 1000.0 / sd.write_us : 0.0) +
+                                ",\"sd_max_write_ms\":" + String(sd.max_write_us / 1000.0) +
+                                ",\"checkpoint\":\"" + String(checkpoint_valid ? checkpoint.name : "") + "\"" +
                                 ",\"name\":\"" + project_name + "\",\"status\":\"stop\"}";
             ws_send_text(send_msg.c_str());
         }
-        delay(800);
+    } else if (_command == SCANNER_COMMAND_RESUME) {
+        scan_resume_loop();
     } else if (_command == SCANNER_COMMAND_HOME) {
-        ESP_LOGD(MODULE_TAG, "Home command");
-        z_steps = z_axis_max;
-        while( digitalRead(BUTTON_PIN) == HIGH ) {
-            z_axis_motor_step(Z_AXIS_MOTOR_DOWN);
+        if (!motion_started) {
+            ESP_LOGD(MODULE_TAG, "Home command");
+            stepper_set_position(STEPPER_AXIS_Z, z_axis_max);
+            z_axis_move(Z_AXIS_MOTOR_DOWN, z_axis_max);
+            motion_started = true;
+        } else if (!stepper_is_busy(STEPPER_AXIS_Z)) {
+            stepper_set_position(STEPPER_AXIS_Z, 0);
+            apply_command(SCANNER_COMMAND_STOP, 0);
+            ESP_LOGD(MODULE_TAG, "Home command done");
+        } else {
+            delay(1);
         }
-        z_steps = 0;
-        set_command(SCANNER_COMMAND_STOP);
-        ESP_LOGD(MODULE_TAG, "Home command done");
     } else if (_command == SCANNER_COMMAND_START && project_name.length() > 0) {
-        for (uint16_t i = 0; i < x_y_axis_one_time_step; i++) {
-            x_y_axis_motor_step(HIGH);
-        }
-
-        double x = 0, y = 0, r = 20;
-        if(vl53_ready) {
-            int16_t distanceMode = get_count_distance(x_y_axis_check_times);
-            r = fabs(double(vl53l1x_center) - double(distanceMode));
-            get_x_y(x_y_steps * MOTOR1_DEFAULT_MICRO_STEP_DEGREE, r,  &x,  &y);
+        if (scan_mode == SCAN_MODE_CONTINUOUS) {
+            scan_continuous_loop();
+        } else if (scan_mode == SCAN_MODE_REFINE) {
+            scan_refine_loop();
+        } else if (scan_mode == SCAN_MODE_HELICAL) {
+            scan_helical_loop();
         } else {
-            get_x_y(x_y_steps * MOTOR1_DEFAULT_MICRO_STEP_DEGREE, r,  &x,  &y);
-            delay(800);
+            scan_step_loop();
         }
-
-        String point = "[" + String(x) + "," + String(y) + "," + String(z_steps * 0.00125) + "]";
-        message = "{\"name\":\"" + project_name + "\"" +
-                    ",\"status\":\"scan\"" +
-                    ",\"points_count\":" + String(++point_count) +
-                    ",\"time\":" + String((millis() - start_time) / 1000.0) +
-                    ",\"is_last\":false" +
-                    ",\"z_steps\":" + String(z_steps) +
-                    ",\"r\":" + String(r) +
-                    ",\"points\":[" + point + "]}";
-
-        ws_send_text(message.c_str());
-
-        x_y_steps += x_y_axis_one_time_step;
-        if(x_y_steps >= x_y_axis_max) {
-            ESP_LOGD(MODULE_TAG, "X Y Full step max count, Z axis steps: %u", z_steps);
-            for (uint16_t i = 0; i < z_axis_one_time_step; i++) {
-                z_axis_motor_step(Z_AXIS_MOTOR_UP);
+    } else if (_command >= SCANNER_COMMAND_UP && _command <= SCANNER_COMMAND_LEFT) {
+        if (!motion_started) {
+            if (_command == SCANNER_COMMAND_UP) {
+                z_axis_move(Z_AXIS_MOTOR_UP, _steps);
+            } else if (_command == SCANNER_COMMAND_DOWN) {
+                z_axis_move(Z_AXIS_MOTOR_DOWN, _steps);
+            } else if (_command == SCANNER_COMMAND_RIGHT) {
+                x_y_axis_move(HIGH, _steps);
+            } else if (_command == SCANNER_COMMAND_LEFT) {
+                x_y_axis_move(LOW, _steps);
             }
-            x_y_steps = 0;
-        }
-
-        if (z_steps >= z_axis_max) {
-            ESP_LOGD(MODULE_TAG, "Z Full step max count and Finish");
-            project_name = "";
-            set_command(SCANNER_COMMAND_STOP);
-        }
-
-    } else {
-        if (_command == SCANNER_COMMAND_UP) {
-            z_axis_motor_step(Z_AXIS_MOTOR_UP);
-        } else if (_command == SCANNER_COMMAND_DOWN) {
-            z_axis_motor_step(Z_AXIS_MOTOR_DOWN);
-        } else if (_command == SCANNER_COMMAND_RIGHT) {
-            x_y_axis_motor_step(HIGH);
-        } else if (_command == SCANNER_COMMAND_LEFT) {
-            x_y_axis_motor_step(LOW);
-        }
-
-        _steps--;
-        if (_steps <= 0) {
+            motion_started = true;
+        } else if (!stepper_is_busy(STEPPER_AXIS_Z) && !stepper_is_busy(STEPPER_AXIS_X_Y)) {
             ESP_LOGD(MODULE_TAG, "Command done");
-            set_command(SCANNER_COMMAND_STOP);
+            apply_command(SCANNER_COMMAND_STOP, 0);
+        } else {
+            delay(1);
         }
     }
 }
 
-void get_x_y(double angle, double r, double* x, double* y) {
-    *x = r * cos(angle * PI / 180);
-    *y = r * sin(angle * PI / 180);
+/**
+ * @brief Turntable position and radius to x and y
+ *
+ * @param x_y_steps `uint32_t`: the turntable position
+ * @param r `uint16_t`: the radius in 0.01 mm
+ * @param x `int32_t*`: x in 0.01 mm
+ * @param y `int32_t*`: y in 0.01 mm
+ */
+void get_x_y(uint32_t x_y_steps, uint16_t r, int32_t* x, int32_t* y) {
+    scanner_kinematics::polar_to_xy(x_y_steps, r, x, y);
 }
 
-uint16_t get_count_distance(uint16_t count) {
-    if (!vl53_ready) return 0;
-    std::vector<int16_t> distances;
-    while(count > 0) {
-        #ifdef CONFIG_VL53L1X
-        while(!vl53.dataReady()) { delay(20); }
-        #endif
-        delay(20);
-        uint16_t distance = get_distance();
-        if (distance < distance_min || distance > distance_max) continue; 
-        distances.push_back(distance);
-        count--;
-    }
-
-    if (distances.size() == 0) return 0;
-    return findMode(distances);
-} 
+/**
+ * @brief Z axis position to height
+ *
+ * @param z_steps `uint32_t`: the Z axis position
+ * @return `int32_t`: the height in 0.01 mm
+ */
+int32_t get_z(uint32_t z_steps) {
+    return scanner_kinematics::z(z_steps);
+}
 
 uint16_t get_distance() {
     if (!vl53_ready) return 0;
-    while(1) {
-        #ifdef CONFIG_VL53L1X
-        if (vl53.dataReady()) {
-            uint32_t distance;
-            uint8_t status;
-            vl53.VL53L1X_GetRangeStatus(&status);
-            if(vl53.GetDistance(&distance) == 0) {
-                vl53.clearInterrupt();
-                return distance;
-            } else {
-                vl53.clearInterrupt();
-                return 0;
-            }
-        }
-        #else
-        if (vl53.isRangeComplete()) {
-            return vl53.readRange();
+    uint16_t distance;
+    unsigned long start = millis();
+    while (!vl53_read(0, &distance)) {
+        if (scanner_abort) return 0;
+        uint32_t elapsed = millis() - start;
+        if (elapsed >= vl53_timeout_ms()) {
+            vl53_timeout(0);
+            return 0;
         }
-        #endif
+        vl53_wait(vl53_polled ? VL53_WAIT_SLICE_MS : vl53_timeout_ms() - elapsed);
+    }
+    return distance;
+}
+
+/**
+ * @brief Sleep until the sensor interrupt, a command or the timeout, whichever comes first
+ *
+ * @param timeout_ms `uint32_t`: the longest sleep
+ * @return `bool`: `false` on timeout
+ */
+bool vl53_wait(uint32_t timeout_ms) {
+    return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(max(timeout_ms, (uint32_t)1))) > 0;
+}
+
+uint32_t vl53_timeout_ms() {
+    return (uint32_t)vl53l1x_timeing_budget * 2 + VL53_TIMEOUT_MARGIN_MS;
+}
+
+/**
+ * @brief Count a missing measurement and rearm the sensor interrupt
+ *
+ * @param sensor `uint8_t`: the sensor
+ */
+void vl53_timeout(uint8_t sensor) {
+    vl53_timeouts++;
+    ESP_LOGW(MODULE_TAG, "VL53 %u timeout, count: %u", sensor, vl53_timeouts);
+    #ifdef CONFIG_VL53L1X
+    vl53l1x_clear_interrupt(&Wire, vl53_sensor_address(sensor));
+    #endif
+}
+
+/**
+ * @brief Read a finished measurement without waiting for one
+ *
+ * The VL53L1X is read with `vl53l1x_read_sample` once its interrupt fired, a sensor without an interrupt pin is polled.
+ *
+ * @param sensor `uint8_t`: the sensor
+ * @param distance `uint16_t*`: the distance in mm, `0` if the sensor reported an error
+ * @return `bool`: `false` if no new measurement is ready
+ */
+bool vl53_read(uint8_t sensor, uint16_t* distance) {
+    if (!vl53_sensor_ready[sensor]) return false;
+    #ifdef CONFIG_VL53L1X
+    bool interrupt = vl53_sensors[sensor].int_pin != VL53_NO_PIN;
+    if (interrupt) {
+        if (!vl53_int_fired[sensor]) return false;
+        vl53_int_fired[sensor] = false;
     }
-}
\ No newline at end of file
+
+    vl53l1x_result_t* result = &vl53_results[sensor];
+    uint32_t transactions = vl53l1x_transactions();
+    if (!vl53l1x_read_sample(&Wire, vl53_sensor_address(sensor), vl53_polarity[sensor], interrupt, result)) return false;
+    *distance = result->status == VL53L1X_STATUS_VALID ? result->distance : 0;
+    vl53_reads++;
+    vl53_reads_transactions += vl53l1x_transactions() - transactions;
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+    if (vl53_zone_settle) {
+        vl53_zone_settle = false;
+        return false;
+    }
+    if (*distance > 0) *distance = max((int32_t)*distance + vl53_zone_offsets[vl53_zone], (int32_t)1);
+#endif
+    return true;
+    #else
+    if (!vl53[sensor].isRangeComplete()) return false;
+    *distance = vl53[sensor].readRange();
+    return true;
+    #endif
+}
+
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+/**
+ * @brief Range with the band of SPAD rows of a zone from the next measurement on
+ *
+ * @param zone `uint8_t`: the zone, `0` is the lowest row
+ */
+void vl53_set_zone(uint8_t zone) {
+    vl53_zone = zone;
+    // The center SPAD of an even sized ROI is the one above and right of its middle, numbered as in the ROI table of UM2555
+    uint8_t row = zone * VL53_ZONE_ROWS + VL53_ZONE_ROWS / 2;
+    uint8_t center = row > 7 ? 128 + (VL53_SPAD_CENTER_COLUMN << 3) + (15 - row) : ((15 - VL53_SPAD_CENTER_COLUMN) << 3) + row;
+    vl53[0].VL53L1X_SetROICenter(center);
+    vl53_zone_settle = true;
+}
+
+/**
+ * @brief Angle of the middle of a zone to the optical axis
+ *
+ * @param zone `uint8_t`: the zone
+ * @return `double`: the angle in radians
+ */
+double vl53_zone_angle(uint8_t zone) {
+    double rows = zone * VL53_ZONE_ROWS + (VL53_ZONE_ROWS - 1) / 2.0 - (VL53_SPAD_ROWS - 1) / 2.0;
+    return rows * VL53_SPAD_PITCH_MDEG / 1000.0 * PI / 180.0;
+}
+
+/**
+ * @brief Height of a zone above the optical axis where it meets the surface
+ *
+ * @param zone `uint8_t`: the zone
+ * @param distance `double`: the measured distance in mm
+ * @return `int32_t`: the height in Z axis steps
+ */
+int32_t vl53_zone_z_steps(uint8_t zone, double distance) {
+    return VL53_ZONE_Z_SIGN * lround(distance * tan(vl53_zone_angle(zone)) / Z_AXIS_STEP_MM);
+}
+
+/**
+ * @brief Z axis travel of a ring, `VL53_ZONE_COUNT` zone pitches at a distance
+ *
+ * @param distance `double`: the distance in mm
+ * @return `uint32_t`: the travel in Z axis steps, at least 1
+ */
+uint32_t vl53_zone_ring_steps(double distance) {
+    double span = distance * (tan(vl53_zone_angle(VL53_ZONE_COUNT - 1)) - tan(vl53_zone_angle(0))) / Z_AXIS_STEP_MM;
+    return max(lround(fabs(span) * VL53_ZONE_COUNT / (VL53_ZONE_COUNT - 1)), 1L);
+}
+#endif
@@ -0,0 +1,161 @@
+// Path: src/components/planner.cpp
+#include "components/planner.h"    // include/components/planner.h
+
+const char* PLANNER_TAG = PLANNER_TAG_NAME;
+
+planner_config_t planner_configs[STEPPER_AXIS_COUNT];
+
+/**
+ * @brief Time to ramp from the start speed to `speed`
+ */
+static float planner_ramp_time(const planner_config_t* config, float speed) {
+    float dv = speed - config->start_speed;
+    if (dv <= 0) return 0;
+    if (config->jerk <= 0) return dv / config->acceleration;
+
+    float a_max = config->acceleration;
+    if (dv >= a_max * a_max / config->jerk) return dv / a_max + a_max / config->jerk;
+    return 2 * sqrtf(dv / config->jerk);
+}
+
+/**
+ * @brief Steps needed to ramp from the start speed to `speed`
+ *
+ * Both ramp shapes are point symmetric, so the mean speed is the mean of both ends.
+ */
+static float planner_ramp_distance(const planner_config_t* config, float speed) {
+    return (config->start_speed + speed) * 0.5f * planner_ramp_time(config, speed);
+}
+
+/**
+ * @brief Speed `t` seconds into a ramp that ends at `speed` after `ramp_time` seconds
+ */
+static float planner_ramp_speed(const planner_config_t* config, float speed, float ramp_time, float t) {
+    if (config->jerk <= 0) return config->start_speed + config->acceleration * t;
+
+    float a_max = config->acceleration;
+    float dv = speed - config->start_speed;
+    float t_jerk = dv >= a_max * a_max / config->jerk ? a_max / config->jerk : ramp_time / 2;
+
+    if (t < t_jerk) return config->start_speed + 0.5f * config->jerk * t * t;
+    if (t > ramp_time - t_jerk) return speed - 0.5f * config->jerk * (ramp_time - t) * (ramp_time - t);
+    return config->start_speed + 0.5f * config->jerk * t_jerk * t_jerk + config->jerk * t_jerk * (t - t_jerk);
+}
+
+/**
+ * @brief Set the motion limits of an axis
+ *
+ * @param axis `uint8_t`: `STEPPER_AXIS_Z` or `STEPPER_AXIS_X_Y`
+ * @param start_speed `uint32_t`: speed a move starts and ends with, in steps/s
+ * @param max_speed `uint32_t`: cruise speed in steps/s
+ * @param acceleration `uint32_t`: acceleration in steps/s^2, `0` runs every move at the start speed
+ * @param jerk `uint32_t`: jerk in steps/s^3, `0` for a trapezoidal profile
+ */
+void planner_set_config(uint8_t axis, uint32_t start_speed, uint32_t max_speed, uint32_t acceleration, uint32_t jerk) {
+    if (axis >= STEPPER_AXIS_COUNT) return;
+    if (start_speed == 0) start_speed = 1;
+
+    planner_configs[axis].start_speed = start_speed;
+    planner_configs[axis].max_speed = max_speed;
+    planner_configs[axis].acceleration = acceleration;
+    planner_configs[axis].jerk = jerk;
+    ESP_LOGD(PLANNER_TAG, "Axis %u start speed: %u, max speed: %u, acceleration: %u, jerk: %u", axis, start_speed, max_speed, acceleration, jerk);
+}
+
+/**
+ * @brief Split a move into acceleration, cruise and deceleration segments
+ *
+ * The ramps are sampled in `PLANNER_RAMP_SEGMENTS` slices of equal time, each slice runs at its mean speed.
+ * Moves too short to reach the max speed get a lower peak speed.
+ *
+ * @param axis `uint8_t`: the axis
+ * @param steps `uint32_t`: the length of the move
+ * @param segments `stepper_segment_t*`: output, room for `STEPPER_MAX_SEGMENTS`
+ * @return `uint8_t`: the number of segments
+ */
+uint8_t planner_plan(uint8_t axis, uint32_t steps, stepper_segment_t* segments) {
+    if (axis >= STEPPER_AXIS_COUNT || steps == 0) return 0;
+
+    const planner_config_t* config = &planner_configs[axis];
+    uint32_t start_half_period = (uint32_t)(500000.0f / config->start_speed);
+
+    if (config->max_speed <= config->start_speed || config->acceleration <= 0) {
+        segments[0].steps = steps;
+        segments[0].half_period_us = start_half_period;
+        return 1;
+    }
+
+    float peak_speed = config->max_speed;
+    if (2 * planner_ramp_distance(config, peak_speed) > steps) {
+        float low = config->start_speed;
+        float high = peak_speed;
+        for (uint8_t i = 0; i < 20; i++) {
+            float middle = (low + high) / 2;
+            if (2 * planner_ramp_distance(config, middle) > steps) high = middle;
+            else low = middle;
+        }
+        peak_speed = low;
+    }
+
+    float ramp_time = planner_ramp_time(config, peak_speed);
+    float slice = ramp_time / PLANNER_RAMP_SEGMENTS;
+    float distance = 0;
+    uint32_t ramp_steps = 0;
+
+    for (uint8_t i = 0; i < PLANNER_RAMP_SEGMENTS; i++) {
+        float t = slice * i;
+        float mean_speed = (planner_ramp_speed(config, peak_speed, ramp_time, t) +
+                            4 * planner_ramp_speed(config, peak_speed, ramp_time, t + slice / 2) +
+                            planner_ramp_speed(config, peak_speed, ramp_time, t + slice)) / 6;
+        distance += mean_speed * slice;
+
+        uint32_t total = (uint32_t)lroundf(distance);
+        segments[i].steps = total - ramp_steps;
+        segments[i].half_period_us = (uint32_t)(500000.0f / mean_speed);
+        ramp_steps = total;
+    }
+
+    for (int8_t i = PLANNER_RAMP_SEGMENTS - 1; i >= 0 && 2 * ramp_steps > steps; i--) {
+        uint32_t excess = (2 * ramp_steps - steps + 1) / 2;
+        if (excess > segments[i].steps) excess = segments[i].steps;
+        segments[i].steps -= excess;
+        ramp_steps -= excess;
+    }
+
+    uint8_t count = PLANNER_RAMP_SEGMENTS;
+    segments[count].steps = steps - 2 * ramp_steps;
+    segments[count].half_period_us = (uint32_t)(500000.0f / peak_speed);
+    count++;
+
+    for (int8_t i = PLANNER_RAMP_SEGMENTS - 1; i >= 0; i--) {
+        segments[count++] = segments[i];
+    }
+    return count;
+}
+
+/**
+ * @brief Duration of a planned move
+ */
+uint64_t planner_move_time_us(const stepper_segment_t* segments, uint8_t count) {
+    uint64_t time_us = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        time_us += (uint64_t)segments[i].steps * segments[i].half_period_us * 2;
+    }
+    return time_us;
+}
+
+/**
+ * @brief Plan a move and start it in the background
+ *
+ * @param axis `uint8_t`: the axis
+ * @param direction `bool`: `HIGH` counts the position up, `LOW` counts it down
+ * @param steps `uint32_t`: the length of the move
+ * @return `bool`: `false` if the axis is still busy
+ */
+bool planner_move(uint8_t axis, bool direction, uint32_t steps) {
+    if (axis >= STEPPER_AXIS_COUNT) return false;
+
+    stepper_segment_t segments[STEPPER_MAX_SEGMENTS];
+    uint8_t count = planner_plan(axis, steps, segments);
+    return stepper_move_segments(axis, direction, segments, count);
+}
@@ -0,0 +1,69 @@
+// Path: src/components/points.cpp
+#include "components/points.h"    // include/components/points.h
+
+// Single producer (scanner task), single consumer (stream task), the indexes run freely and wrap
+scanner_point_t point_buffer[POINT_BUFFER_SIZE];
+std::atomic<uint32_t> point_buffer_head(0);
+std::atomic<uint32_t> point_buffer_tail(0);
+
+std::atomic<uint32_t> point_buffer_hwm(0);
+std::atomic<uint32_t> point_buffer_drops(0);
+
+/**
+ * @brief Append a point, only called by the producer
+ *
+ * @param point `const scanner_point_t*`: the point, copied
+ * @return `bool`: `false` if the buffer is full and the point was dropped
+ */
+bool point_buffer_push(const scanner_point_t* point) {
+    uint32_t head = point_buffer_head.load(std::memory_order_relaxed);
+    uint32_t used = head - point_buffer_tail.load(std::memory_order_acquire);
+    if (used >= POINT_BUFFER_SIZE) {
+        point_buffer_drops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    point_buffer[head & (POINT_BUFFER_SIZE - 1)] = *point;
+    point_buffer_head.store(head + 1, std::memory_order_release);
+
+    if (used + 1 > point_buffer_hwm.load(std::memory_order_relaxed)) {
+        point_buffer_hwm.store(used + 1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+/**
+ * @brief Take up to `max_count` of the oldest points, only called by the consumer
+ *
+ * @param points `scanner_point_t*`: output
+ * @param max_count `size_t`: the room in `points`
+ * @return `size_t`: the number of points taken
+ */
+size_t point_buffer_pop(scanner_point_t* points, size_t max_count) {
+    uint32_t tail = point_buffer_tail.load(std::memory_order_relaxed);
+    uint32_t count = point_buffer_head.load(std::memory_order_acquire) - tail;
+    if (count > max_count) count = max_count;
+
+    for (uint32_t i = 0; i < count; i++) {
+        points[i] = point_buffer[(tail + i) & (POINT_BUFFER_SIZE - 1)];
+    }
+    point_buffer_tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+uint32_t point_buffer_count() {
+    return point_buffer_head.load(std::memory_order_acquire) - point_buffer_tail.load(std::memory_order_acquire);
+}
+
+uint32_t point_buffer_high_water_mark() {
+    return point_buffer_hwm.load(std::memory_order_relaxed);
+}
+
+uint32_t point_buffer_dropped() {
+    return point_buffer_drops.load(std::memory_order_relaxed);
+}
+
+void point_buffer_reset_stats() {
+    point_buffer_hwm.store(point_buffer_count(), std::memory_order_relaxed);
+    point_buffer_drops.store(0, std::memory_order_relaxed);
+}
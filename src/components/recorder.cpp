@@ -0,0 +1,495 @@
+// Path: src/components/recorder.cpp
+#include "components/recorder.h"    // include/components/recorder.h
+
+#include "components/module.h"
+
+const char* RECORDER_TAG = RECORDER_TAG_NAME;
+
+static_assert(RECORDER_BUFFER_SIZE % sizeof(recorder_record_t) == 0, "A buffer must end on a whole record");
+static_assert(RECORDER_BUFFER_SIZE % 512 == 0, "A buffer must end on a whole SD block");
+
+bool sd_card_ready = false;
+
+fs::FS* recorder_fs = NULL;
+QueueHandle_t recorder_queue = NULL;
+TaskHandle_t recorder_task_handle = NULL;
+// Given by the recorder task once a RECORDER_MESSAGE_SYNC is on the card
+SemaphoreHandle_t recorder_synced = NULL;
+
+// Filled by the scanner task, written by the recorder task
+uint8_t recorder_buffers[2][RECORDER_BUFFER_SIZE];
+volatile bool recorder_buffer_busy[2] = { false, false };
+uint8_t recorder_active = 0;
+uint16_t recorder_fill = 0;
+bool recorder_recording = false;
+
+portMUX_TYPE recorder_mux = portMUX_INITIALIZER_UNLOCKED;
+recorder_stats_t recorder_stats;
+
+// Owned by the recorder task
+File recorder_file;
+File recorder_index;
+recorder_header_t recorder_header;
+unsigned long recorder_sync_time = 0;
+// The catalogue entry of the recording, its duration runs from recorder_entry_time on
+catalog_entry_t recorder_entry;
+unsigned long recorder_entry_time = 0;
+uint32_t recorder_entry_duration = 0;
+
+void recorder_task(void* parameter);
+void recorder_handle(const recorder_message_t* message);
+bool recorder_send(uint8_t type, uint8_t buffer, uint16_t length, const char* name, uint32_t seq = 0);
+void recorder_open(const char* name);
+void recorder_reopen(const char* name, uint32_t seq);
+void recorder_write(uint8_t buffer, uint16_t length);
+void recorder_sync();
+void recorder_close();
+void recorder_count_records(uint32_t end);
+
+/**
+ * @brief Mount the SD card and start the task that writes it
+ */
+void init_recorder() {
+    SPI.begin(SPI_SCK, SPI_MISO, SPI_MOSI, SPI_CS);
+    if (!SD.begin(SPI_CS)) {
+        ESP_LOGW(RECORDER_TAG, "No SD card, scans are not recorded");
+        return;
+    }
+    if (!SD.exists(RECORDER_DIR)) SD.mkdir(RECORDER_DIR);
+    recorder_fs = &SD;
+    sd_card_ready = true;
+    init_catalog();
+
+    recorder_queue = xQueueCreate(RECORDER_QUEUE_LENGTH, sizeof(recorder_message_t));
+    recorder_synced = xSemaphoreCreateBinary();
+    if (recorder_queue == NULL || recorder_synced == NULL) {
+        ESP_LOGE(RECORDER_TAG, "Failed to create the recorder queue");
+        return;
+    }
+    if (xTaskCreatePinnedToCore(recorder_task, "recorder", RECORDER_TASK_STACK_SIZE, NULL, RECORDER_TASK_PRIORITY, &recorder_task_handle, RECORDER_TASK_CORE) != pdPASS) {
+        ESP_LOGE(RECORDER_TAG, "Failed to create the recorder task");
+    }
+}
+
+bool recorder_ready() {
+    return sd_card_ready && recorder_task_handle != NULL;
+}
+
+/**
+ * @brief Start a recording, called by the scanner task
+ *
+ * @param name `const char*`: the project name, also the file name
+ */
+void recorder_start(const char* name) {
+    if (!recorder_ready()) return;
+    if (recorder_recording) recorder_stop();
+
+    portENTER_CRITICAL(&recorder_mux);
+    memset(&recorder_stats, 0, sizeof(recorder_stats));
+    portEXIT_CRITICAL(&recorder_mux);
+
+    recorder_fill = 0;
+    recorder_recording = recorder_send(RECORDER_MESSAGE_START, 0, 0, name);
+}
+
+/**
+ * @brief Continue a recording from the start of a ring, what was recorded from that ring on is replaced
+ *
+ * @param name `const char*`: the project name
+ * @param seq `uint32_t`: the last point to keep, the ring after it is recorded again
+ */
+void recorder_resume(const char* name, uint32_t seq) {
+    if (!recorder_ready()) return;
+    if (recorder_recording) recorder_stop();
+
+    portENTER_CRITICAL(&recorder_mux);
+    memset(&recorder_stats, 0, sizeof(recorder_stats));
+    portEXIT_CRITICAL(&recorder_mux);
+
+    recorder_fill = 0;
+    recorder_recording = recorder_send(RECORDER_MESSAGE_RESUME, 0, 0, name, seq);
+}
+
+/**
+ * @brief Add a point to the active buffer and hand the buffer over once it is full, never waits for the card
+ *
+ * @param point `const scanner_point_t*`: the point
+ */
+void recorder_push(const scanner_point_t* point) {
+    if (!recorder_recording) return;
+
+    if (recorder_buffer_busy[recorder_active]) {
+        // The card fell two buffers behind
+        portENTER_CRITICAL(&recorder_mux);
+        recorder_stats.dropped++;
+        portEXIT_CRITICAL(&recorder_mux);
+        return;
+    }
+
+    recorder_record_t* record = (recorder_record_t*)&recorder_buffers[recorder_active][recorder_fill];
+    record->seq = point->seq;
+    record->time_ms = point->time_ms;
+    record->z_steps = point->z_steps;
+    record->x_y_steps = point->x_y_steps;
+    record->r = point->r;
+    record->flags = point->flags;
+    memset(record->reserved, 0, sizeof(record->reserved));
+    recorder_fill += sizeof(recorder_record_t);
+
+    if (recorder_fill + sizeof(recorder_record_t) > RECORDER_BUFFER_SIZE) {
+        recorder_buffer_busy[recorder_active] = true;
+        recorder_send(RECORDER_MESSAGE_BUFFER, recorder_active, recorder_fill, NULL);
+        recorder_active ^= 1;
+        recorder_fill = 0;
+    }
+}
+
+/**
+ * @brief Put every point pushed so far on the card, header and index included, called by the scanner task
+ *
+ * Blocks until the recorder task confirms, at most `RECORDER_FLUSH_MS`. A checkpoint must not run ahead of the recording,
+ * or a resume after a power cut would lose the rings in between.
+ *
+ * @return `bool`: `false` if the points may not be on the card, `true` without a recording
+ */
+bool recorder_flush() {
+    if (!recorder_recording) return true;
+
+    // A busy active buffer never took a point, see recorder_push
+    if (recorder_fill > 0 && !recorder_buffer_busy[recorder_active]) {
+        recorder_buffer_busy[recorder_active] = true;
+        bool sent = recorder_send(RECORDER_MESSAGE_BUFFER, recorder_active, recorder_fill, NULL);
+        recorder_active ^= 1;
+        recorder_fill = 0;
+        if (!sent) return false;
+    }
+
+    // A confirmation of an earlier flush that timed out
+    xSemaphoreTake(recorder_synced, 0);
+    if (!recorder_send(RECORDER_MESSAGE_SYNC, 0, 0, NULL)) return false;
+    return xSemaphoreTake(recorder_synced, pdMS_TO_TICKS(RECORDER_FLUSH_MS)) == pdTRUE;
+}
+
+/**
+ * @brief Hand over the partial buffer and close the recording
+ */
+void recorder_stop() {
+    if (!recorder_recording) return;
+    recorder_recording = false;
+
+    if (recorder_fill > 0 && !recorder_buffer_busy[recorder_active]) {
+        recorder_buffer_busy[recorder_active] = true;
+        recorder_send(RECORDER_MESSAGE_BUFFER, recorder_active, recorder_fill, NULL);
+        recorder_active ^= 1;
+    }
+    recorder_fill = 0;
+    recorder_send(RECORDER_MESSAGE_STOP, 0, 0, NULL);
+}
+
+recorder_stats_t recorder_get_stats() {
+    portENTER_CRITICAL(&recorder_mux);
+    recorder_stats_t stats = recorder_stats;
+    portEXIT_CRITICAL(&recorder_mux);
+    return stats;
+}
+
+bool recorder_send(uint8_t type, uint8_t buffer, uint16_t length, const char* name, uint32_t seq) {
+    recorder_message_t message;
+    message.type = type;
+    message.buffer = buffer;
+    message.length = length;
+    message.seq = seq;
+    message.name[0] = '\0';
+    if (name != NULL) {
+        strncpy(message.name, name, RECORDER_NAME_LENGTH - 1);
+        message.name[RECORDER_NAME_LENGTH - 1] = '\0';
+    }
+
+    if (xQueueSend(recorder_queue, &message, 0) != pdTRUE) {
+        ESP_LOGW(RECORDER_TAG, "Recorder queue full, drop message: %u", type);
+        if (type == RECORDER_MESSAGE_BUFFER) {
+            // The points of the buffer never reach the card
+            portENTER_CRITICAL(&recorder_mux);
+            recorder_stats.dropped += length / sizeof(recorder_record_t);
+            portEXIT_CRITICAL(&recorder_mux);
+            recorder_buffer_busy[buffer] = false;
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Write the handed over buffers, sync the header and the index every `RECORDER_SYNC_MS`
+ */
+void recorder_task(void* parameter) {
+    recorder_message_t message;
+
+    for (;;) {
+        if (xQueueReceive(recorder_queue, &message, pdMS_TO_TICKS(RECORDER_SYNC_MS)) == pdTRUE) {
+            recorder_handle(&message);
+        }
+
+        if (recorder_file && millis() - recorder_sync_time >= RECORDER_SYNC_MS) {
+            recorder_sync();
+        }
+    }
+}
+
+/**
+ * @brief Carry out one message of the scanner task
+ *
+ * @param message `const recorder_message_t*`: the message
+ */
+void recorder_handle(const recorder_message_t* message) {
+    if (message->type == RECORDER_MESSAGE_START) {
+        recorder_open(message->name);
+    } else if (message->type == RECORDER_MESSAGE_BUFFER) {
+        recorder_write(message->buffer, message->length);
+        recorder_buffer_busy[message->buffer] = false;
+    } else if (message->type == RECORDER_MESSAGE_STOP) {
+        recorder_close();
+    } else if (message->type == RECORDER_MESSAGE_RESUME) {
+        recorder_reopen(message->name, message->seq);
+    } else if (message->type == RECORDER_MESSAGE_SYNC) {
+        if (recorder_file) recorder_sync();
+        xSemaphoreGive(recorder_synced);
+    }
+}
+
+/**
+ * @brief Path of a recording without the extension, the name keeps the characters every file system takes
+ */
+String recorder_path(const char* name) {
+    char file_name[RECORDER_NAME_LENGTH];
+    recorder_file_name(name, file_name);
+    return String(RECORDER_DIR) + "/" + file_name;
+}
+
+/**
+ * @brief File name of a recording without the extension
+ *
+ * @param name `const char*`: the project name
+ * @param file_name `char*`: room for `RECORDER_NAME_LENGTH` characters
+ */
+void recorder_file_name(const char* name, char* file_name) {
+    size_t i = 0;
+    for (; name[i] != '\0' && i < RECORDER_NAME_LENGTH - 1; i++) {
+        file_name[i] = isalnum(name[i]) || name[i] == '-' || name[i] == '_' ? name[i] : '_';
+    }
+    file_name[i] = '\0';
+}
+
+void recorder_open(const char* name) {
+    if (recorder_file) recorder_close();
+
+    String path = recorder_path(name);
+    recorder_file = recorder_fs->open((path + ".bin").c_str(), FILE_WRITE);
+    recorder_index = recorder_fs->open((path + ".idx").c_str(), FILE_WRITE);
+    if (!recorder_file || !recorder_index) {
+        ESP_LOGE(RECORDER_TAG, "Failed to open %s", path.c_str());
+        if (recorder_file) recorder_file.close();
+        if (recorder_index) recorder_index.close();
+        return;
+    }
+
+    memset(&recorder_header, 0, sizeof(recorder_header));
+    memcpy(recorder_header.magic, RECORDER_MAGIC, sizeof(recorder_header.magic));
+    recorder_header.version = RECORDER_VERSION;
+    recorder_header.record_size = sizeof(recorder_record_t);
+    recorder_header.header_size = RECORDER_HEADER_SIZE;
+    strncpy(recorder_header.name, name, RECORDER_NAME_LENGTH - 1);
+
+    // The whole header block, so the records start block aligned
+    uint8_t block[RECORDER_HEADER_SIZE] = { 0 };
+    memcpy(block, &recorder_header, sizeof(recorder_header));
+    recorder_file.write(block, sizeof(block));
+
+    catalog_begin(&recorder_entry, name);
+    recorder_entry_duration = 0;
+    recorder_entry_time = millis();
+    catalog_put(&recorder_entry);
+
+    recorder_sync_time = millis();
+    ESP_LOGI(RECORDER_TAG, "Recording %s", path.c_str());
+}
+
+/**
+ * @brief Open a recording again and cut it at the first ring after point `seq`
+ *
+ * Only what the last sync put on the card counts, a recording that can not be read is started over.
+ *
+ * @param name `const char*`: the project name
+ * @param seq `uint32_t`: the last point to keep
+ */
+void recorder_reopen(const char* name, uint32_t seq) {
+    if (recorder_file) recorder_close();
+
+    String path = recorder_path(name);
+    if (!recorder_fs->exists((path + ".bin").c_str()) || !recorder_fs->exists((path + ".idx").c_str())) {
+        recorder_open(name);
+        return;
+    }
+
+    recorder_file = recorder_fs->open((path + ".bin").c_str(), RECORDER_FILE_UPDATE);
+    recorder_index = recorder_fs->open((path + ".idx").c_str(), RECORDER_FILE_UPDATE);
+    if (!recorder_file || !recorder_index ||
+        recorder_file.read((uint8_t*)&recorder_header, sizeof(recorder_header)) != sizeof(recorder_header) ||
+        memcmp(recorder_header.magic, RECORDER_MAGIC, sizeof(recorder_header.magic)) != 0 ||
+        recorder_header.record_size != sizeof(recorder_record_t) || recorder_header.header_size != RECORDER_HEADER_SIZE) {
+        ESP_LOGW(RECORDER_TAG, "Can not resume %s, start over", path.c_str());
+        if (recorder_file) recorder_file.close();
+        if (recorder_index) recorder_index.close();
+        recorder_open(name);
+        return;
+    }
+
+    uint32_t end = RECORDER_HEADER_SIZE + recorder_header.records * (uint32_t)sizeof(recorder_record_t);
+    uint32_t entries = 0;
+    recorder_index_t entry;
+    while (recorder_index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry)) {
+        if (entry.seq > seq || entry.offset >= end) {
+            end = min(end, entry.offset);
+            break;
+        }
+        entries++;
+    }
+
+    // Later entries and records are overwritten, the header count marks the end
+    recorder_index.seek(entries * sizeof(recorder_index_t));
+    recorder_header.records = (end - RECORDER_HEADER_SIZE) / sizeof(recorder_record_t);
+    recorder_header.version = RECORDER_VERSION;
+
+    // The entry keeps the module settings and the time of the scan before the resume
+    if (!catalog_get(name, &recorder_entry)) catalog_begin(&recorder_entry, name);
+    recorder_entry.state = CATALOG_STATE_RECORDING;
+    recorder_entry_duration = recorder_entry.duration_ms;
+    recorder_entry_time = millis();
+    recorder_count_records(end);
+    recorder_header.surface = recorder_entry.surface;
+    recorder_file.seek(end);
+
+    recorder_sync_time = millis();
+    ESP_LOGI(RECORDER_TAG, "Resume %s after %u points", path.c_str(), recorder_header.records);
+}
+
+void recorder_write(uint8_t buffer, uint16_t length) {
+    if (!recorder_file) return;
+
+    // One index entry for the first record of every ring
+    const recorder_record_t* records = (const recorder_record_t*)recorder_buffers[buffer];
+    uint16_t count = length / sizeof(recorder_record_t);
+    for (uint16_t i = 0; i < count; i++) {
+        if (!(records[i].flags & POINT_FLAG_RING)) continue;
+        recorder_index_t entry = { records[i].z_steps, records[i].seq, RECORDER_HEADER_SIZE + (recorder_header.records + i) * (uint32_t)sizeof(recorder_record_t) };
+        recorder_index.write((const uint8_t*)&entry, sizeof(entry));
+    }
+
+    unsigned long start = micros();
+    size_t written = recorder_file.write(recorder_buffers[buffer], length);
+    uint32_t elapsed = micros() - start;
+
+    recorder_header.records += written / sizeof(recorder_record_t);
+    catalog_add_records(&recorder_entry, records, written / sizeof(recorder_record_t));
+    recorder_header.surface = recorder_entry.surface;
+
+    portENTER_CRITICAL(&recorder_mux);
+    recorder_stats.records = recorder_header.records;
+    recorder_stats.bytes += written;
+    recorder_stats.write_us += elapsed;
+    if (elapsed > recorder_stats.max_write_us) recorder_stats.max_write_us = elapsed;
+    if (written < length) recorder_stats.dropped += (length - written) / sizeof(recorder_record_t);
+    portEXIT_CRITICAL(&recorder_mux);
+
+    if (written < length) ESP_LOGE(RECORDER_TAG, "SD write short: %u of %u", written, length);
+}
+
+/**
+ * @brief Rewrite the header with the record count and push both files to the card
+ */
+void recorder_sync() {
+    recorder_header.dropped = recorder_get_stats().dropped;
+
+    size_t end = recorder_file.position();
+    recorder_file.seek(0);
+    recorder_file.write((const uint8_t*)&recorder_header, sizeof(recorder_header));
+    recorder_file.seek(end);
+    recorder_file.flush();
+    recorder_index.flush();
+
+    recorder_entry.data_end = end;
+    recorder_entry.index_end = recorder_index.position();
+    recorder_entry.duration_ms = recorder_entry_duration + (millis() - recorder_entry_time);
+    catalog_put(&recorder_entry);
+    recorder_sync_time = millis();
+}
+
+/**
+ * @brief Count the records up to `end` into the catalogue entry again, a resumed recording keeps only part of them
+ *
+ * @param end `uint32_t`: the file offset the records end at
+ */
+void recorder_count_records(uint32_t end) {
+    // The scanner task may already fill the buffers again
+    recorder_record_t records[RECORDER_HEADER_SIZE / sizeof(recorder_record_t)];
+    catalog_clear_records(&recorder_entry);
+    recorder_file.seek(RECORDER_HEADER_SIZE);
+    for (uint32_t offset = RECORDER_HEADER_SIZE; offset < end; ) {
+        size_t length = min((uint32_t)sizeof(records), end - offset);
+        if (recorder_file.read((uint8_t*)records, length) != length) break;
+        catalog_add_records(&recorder_entry, records, length / sizeof(recorder_record_t));
+        offset += length;
+    }
+}
+
+/**
+ * @brief A record size the readers take, the current one or the narrow one of versions 1 and 2
+ */
+bool recorder_record_size_valid(uint8_t record_size) {
+    return record_size == sizeof(recorder_record_t) || record_size == sizeof(recorder_record_v2_t);
+}
+
+/**
+ * @brief Read records from the current position of a recording, older records are widened
+ *
+ * @param file `File&`: the `.bin` file
+ * @param record_size `uint8_t`: the record size of its header
+ * @param records `recorder_record_t*`: output
+ * @param count `size_t`: the records to read
+ * @return `size_t`: the records read
+ */
+size_t recorder_read_records(File& file, uint8_t record_size, recorder_record_t* records, size_t count) {
+    if (record_size == sizeof(recorder_record_t)) {
+        return file.read((uint8_t*)records, count * sizeof(recorder_record_t)) / sizeof(recorder_record_t);
+    }
+
+    // Read into the end of the output, widening from the front never overwrites a record still to be read
+    uint8_t* narrow = (uint8_t*)records + count * (sizeof(recorder_record_t) - sizeof(recorder_record_v2_t));
+    size_t read = file.read(narrow, count * sizeof(recorder_record_v2_t)) / sizeof(recorder_record_v2_t);
+    for (size_t i = 0; i < read; i++) {
+        recorder_record_v2_t old;
+        memcpy(&old, narrow + i * sizeof(old), sizeof(old));
+        recorder_record_t* record = &records[i];
+        record->seq = old.seq;
+        record->time_ms = old.time_ms;
+        record->z_steps = old.z_steps;
+        record->x_y_steps = old.x_y_steps;
+        record->r = old.r;
+        record->flags = old.flags;
+        memset(record->reserved, 0, sizeof(record->reserved));
+    }
+    return read;
+}
+
+fs::FS* recorder_filesystem() {
+    return recorder_fs;
+}
+
+void recorder_close() {
+    if (!recorder_file) return;
+    recorder_entry.state = CATALOG_STATE_DONE;
+    recorder_sync();
+    recorder_file.close();
+    recorder_index.close();
+    ESP_LOGI(RECORDER_TAG, "Recorded %u points", recorder_header.records);
+}
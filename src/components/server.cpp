@@ -6,29 +6,42 @@ const char* SERVER_TAG = SERVER_TAG_NAME;
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 
-void message(const char* message);
+portMUX_TYPE ws_clients_mux = portMUX_INITIALIZER_UNLOCKED;
+ws_client_t ws_clients[WS_MAX_CLIENTS];
+uint8_t ws_client_count = 0;
+
+void message(AsyncWebSocketClient *client, const char* message);
+void ws_set_client_format(uint32_t id, uint8_t format);
+void ws_remove_client(uint32_t id);
+void ws_request_replay(uint32_t id, uint32_t seq);
+uint8_t scan_mode_from_name(const char* name);
+void scan_entry_json(JsonObject scan, const catalog_entry_t* entry, bool full);
+size_t scans_list_read(scans_list_t* scans, uint8_t* buffer, size_t max_length);
+bool scans_list_next(scans_list_t* scans);
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
 
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len) {
     switch(type) {
         case WS_EVT_CONNECT:
             Serial.printf("WebSocket client #%u connected from %s\n", client->id(), client->remoteIP().toString().c_str());
+            ws_set_client_format(client->id(), STREAM_FORMAT_JSON);
             break;
         case WS_EVT_DISCONNECT:
             Serial.printf("WebSocket client #%u disconnected\n", client->id());
+            ws_remove_client(client->id());
             break;
         case WS_EVT_DATA:
             AwsFrameInfo *info = (AwsFrameInfo*)arg;
             if(info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
                 data[len] = 0;
                 Serial.printf("WebSocket client #%u message: %s\n", client->id(), (char*)data);
-                message((char*)data);
+                message(client, (char*)data);
             }
             break;
     }
 }
 
-void message(const char* message) {
+void message(AsyncWebSocketClient *client, const char* message) {
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, message);
     if (error) {
@@ -37,16 +50,30 @@ void message(const char* message) {
         return;
     }
 
+    if(!doc["format"].isNull()) {
+        ws_set_client_format(client->id(), stream_format_from_name(doc["format"]));
+    }
+
     if(!doc["command"].isNull()) {
         if (doc["command"] == "home") {
             set_command(SCANNER_COMMAND_HOME);
         } else if (doc["command"] == "new") {
             if (!doc["name"].isNull()) {
+                if (!doc["mode"].isNull()) set_scan_mode(scan_mode_from_name(doc["mode"]));
+                if (!doc["estimator"].isNull()) set_estimator(estimator_from_name(doc["estimator"]));
+                if (!doc["skip"].isNull()) set_fast_skip(doc["skip"]);
                 set_project_name(doc["name"]);
                 set_command(SCANNER_COMMAND_START);
             }
         } else if (doc["command"] == "start") {
+            if (!doc["mode"].isNull()) set_scan_mode(scan_mode_from_name(doc["mode"]));
+            if (!doc["estimator"].isNull()) set_estimator(estimator_from_name(doc["estimator"]));
+            if (!doc["skip"].isNull()) set_fast_skip(doc["skip"]);
             set_command(SCANNER_COMMAND_START);
+        } else if (doc["command"] == "resume") {
+            set_command(SCANNER_COMMAND_RESUME);
+        } else if (doc["command"] == "replay") {
+            ws_request_replay(client->id(), doc["seq"].isNull() ? 0 : (uint32_t)doc["seq"]);
         } else if (doc["command"] == "stop") {
             set_command(SCANNER_COMMAND_STOP);
         } else if (doc["command"] == "up") {
@@ -79,6 +106,142 @@ void message(const char* message) {
     doc.clear();
 }
 
+uint8_t scan_mode_from_name(const char* name) {
+    if (name != NULL && strcmp(name, "continuous") == 0) return SCAN_MODE_CONTINUOUS;
+    if (name != NULL && strcmp(name, "refine") == 0) return SCAN_MODE_REFINE;
+    if (name != NULL && strcmp(name, "helical") == 0) return SCAN_MODE_HELICAL;
+    return SCAN_MODE_STEP;
+}
+
+/**
+ * @brief Fill a scan of the catalogue into a JSON object
+ *
+ * @param scan `JsonObject`: the object
+ * @param entry `const catalog_entry_t*`: the scan
+ * @param full `bool`: `false` for the short form of the listing
+ */
+void scan_entry_json(JsonObject scan, const catalog_entry_t* entry, bool full) {
+    scan["name"] = entry->name;
+    scan["state"] = catalog_state_name(entry->state);
+    scan["records"] = entry->records;
+    scan["surface"] = entry->surface;
+    scan["duration_ms"] = entry->duration_ms;
+    if (!full) return;
+
+    JsonObject bbox = scan.createNestedObject("bbox");
+    if (entry->surface > 0) {
+        JsonArray min = bbox.createNestedArray("min");
+        min.add(entry->min_x);
+        min.add(entry->min_y);
+        min.add(entry->min_z);
+        JsonArray max = bbox.createNestedArray("max");
+        max.add(entry->max_x);
+        max.add(entry->max_y);
+        max.add(entry->max_z);
+    }
+
+    String path = recorder_path(entry->name);
+    JsonObject files = scan.createNestedObject("files");
+    files["data"] = path + ".bin";
+    files["data_offset"] = entry->data_offset;
+    files["data_end"] = entry->data_end;
+    files["index"] = path + ".idx";
+    files["index_end"] = entry->index_end;
+    files["rings"] = entry->index_end / sizeof(recorder_index_t);
+
+    JsonObject module = scan.createNestedObject("module");
+    module["z_axis_max"] = entry->z_axis_max;
+    module["z_axis_start_step"] = entry->z_axis_start_step;
+    module["z_axis_delay_time"] = entry->z_axis_delay_time;
+    module["z_axis_one_time_step"] = entry->z_axis_one_time_step;
+    module["x_y_axis_max"] = entry->x_y_axis_max;
+    module["x_y_axis_check_times"] = entry->x_y_axis_check_times;
+    module["x_y_axis_step_delay_time"] = entry->x_y_axis_step_delay_time;
+    module["x_y_axis_one_time_step"] = entry->x_y_axis_one_time_step;
+    module["vl53l1x_center"] = entry->vl53l1x_center;
+    module["vl53l1x_timeing_budget"] = entry->vl53l1x_timeing_budget;
+}
+
+/**
+ * @brief Fill a piece of the listing, called by the web server as the client takes the data
+ *
+ * @return `size_t`: the bytes filled, `0` at the end
+ */
+size_t scans_list_read(scans_list_t* scans, uint8_t* buffer, size_t max_length) {
+    size_t filled = 0;
+    while (filled < max_length) {
+        if (scans->pending_sent == scans->pending_length && !scans_list_next(scans)) break;
+        size_t length = min((size_t)(scans->pending_length - scans->pending_sent), max_length - filled);
+        memcpy(buffer + filled, scans->pending + scans->pending_sent, length);
+        scans->pending_sent += length;
+        filled += length;
+    }
+    return filled;
+}
+
+bool scans_list_next(scans_list_t* scans) {
+    scans->pending_length = 0;
+    scans->pending_sent = 0;
+
+    if (scans->part == 0) {
+        scans->part = 1;
+        scans->pending_length = snprintf(scans->pending, SCANS_LIST_PENDING_SIZE, "{\"code\": 200,\"status\": \"ok\",\"path\": \"/api/scans\",\"data\": [");
+        return true;
+    }
+    if (scans->part == 1) {
+        catalog_entry_t entry;
+        if (catalog_list_next(&scans->list, &entry)) {
+            JsonDocument doc;
+            scan_entry_json(doc.to<JsonObject>(), &entry, false);
+            if (!scans->first) scans->pending[scans->pending_length++] = ',';
+            scans->first = false;
+            scans->pending_length += serializeJson(doc, scans->pending + scans->pending_length, SCANS_LIST_PENDING_SIZE - scans->pending_length);
+            return true;
+        }
+        scans->part = 2;
+    }
+    if (scans->part == 2) {
+        scans->part = 3;
+        scans->pending_length = snprintf(scans->pending, SCANS_LIST_PENDING_SIZE, "]}");
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Read a single `Range: bytes=a-b` header
+ *
+ * @param request `AsyncWebServerRequest*`: the request
+ * @param length `size_t`: the size of the download
+ * @param start `size_t*`: the first byte of the range
+ * @param end `size_t*`: the last byte of the range
+ * @return `int`: `200` without a range, `206` for a range, `416` if the range does not fit the download
+ */
+int export_range(AsyncWebServerRequest *request, size_t length, size_t* start, size_t* end) {
+    *start = 0;
+    *end = length - 1;
+    if (!request->hasHeader("Range")) return 200;
+
+    const char* range = request->getHeader("Range")->value().c_str();
+    if (strncmp(range, "bytes=", 6) != 0 || strchr(range, ',') != NULL) return 416;
+    range += 6;
+
+    char* dash = NULL;
+    if (*range == '-') {
+        // The last n bytes
+        size_t suffix = strtoul(range + 1, &dash, 10);
+        if (suffix == 0 || length == 0) return 416;
+        *start = suffix >= length ? 0 : length - suffix;
+        return 206;
+    }
+
+    *start = strtoul(range, &dash, 10);
+    if (dash == range || *dash != '-') return 416;
+    if (*(dash + 1) != '\0') *end = min((size_t)strtoul(dash + 1, NULL, 10), length - 1);
+    if (*start >= length || *start > *end) return 416;
+    return 206;
+}
+
 void init_server() {
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
 
@@ -106,12 +269,37 @@ void init_server() {
         uint16_t vl53l1x_center = NVS_VL53L1X_CENTER_DEFAULT;
         uint16_t vl53l1x_timeing_budget = NVS_VL53L1X_TIMEING_BUDGET_DEFAULT;
 
+        uint32_t z_axis_max_speed = NVS_Z_AXIS_MAX_SPEED_DEFAULT;
+        uint32_t z_axis_acceleration = NVS_Z_AXIS_ACCELERATION_DEFAULT;
+        uint32_t z_axis_jerk = NVS_Z_AXIS_JERK_DEFAULT;
+        uint32_t x_y_axis_max_speed = NVS_X_Y_AXIS_MAX_SPEED_DEFAULT;
+        uint32_t x_y_axis_acceleration = NVS_X_Y_AXIS_ACCELERATION_DEFAULT;
+        uint32_t x_y_axis_jerk = NVS_X_Y_AXIS_JERK_DEFAULT;
+
+        uint16_t sample_bound = NVS_SAMPLE_BOUND_DEFAULT;
+        uint16_t sample_min = NVS_SAMPLE_MIN_DEFAULT;
+        uint16_t sample_max = NVS_SAMPLE_MAX_DEFAULT;
+
+        uint8_t filter_window = NVS_FILTER_WINDOW_DEFAULT;
+        uint16_t filter_outlier = NVS_FILTER_OUTLIER_DEFAULT;
+        uint16_t filter_ring = NVS_FILTER_RING_DEFAULT;
+        uint8_t filter_smooth = NVS_FILTER_SMOOTH_DEFAULT;
+        uint8_t filter_drop = NVS_FILTER_DROP_DEFAULT;
+        uint16_t voxel_size = NVS_VOXEL_SIZE_DEFAULT;
+
+        stream_policy_t policy = stream_get_policy();
+
         get_sta_wifi(&ssid, &password);
         get_ap_wifi(&ap_ssid, &ap_password);
         get_mdns_hostname(&hostname);
         get_module(&z_axis_max, &z_axis_start_step, &z_axis_delay_time, &z_axis_one_time_step, 
                     &x_y_axis_max, &x_y_axis_check_times, &x_y_axis_step_delay_time, &x_y_axis_one_time_step,
                     &vl53l1x_center, &vl53l1x_timeing_budget);
+        get_motion(&z_axis_max_speed, &z_axis_acceleration, &z_axis_jerk,
+                    &x_y_axis_max_speed, &x_y_axis_acceleration, &x_y_axis_jerk);
+        get_sampling(&sample_bound, &sample_min, &sample_max);
+        get_filter(&filter_window, &filter_outlier, &filter_ring, &filter_smooth, &filter_drop);
+        get_voxel(&voxel_size);
         get_github(&username, &repo);
         if (ssid != NULL && password != NULL && ap_ssid != NULL && ap_password != NULL && hostname != NULL && username != NULL && repo != NULL) {
             JsonDocument doc;
@@ -143,6 +331,53 @@ void init_server() {
             module["vl53l1x_center"] = vl53l1x_center;
             module["vl53l1x_timeing_budget"] = vl53l1x_timeing_budget;
 
+            JsonObject motion = data.createNestedObject("motion");
+            motion["z_axis_max_speed"] = z_axis_max_speed;
+            motion["z_axis_acceleration"] = z_axis_acceleration;
+            motion["z_axis_jerk"] = z_axis_jerk;
+            motion["x_y_axis_max_speed"] = x_y_axis_max_speed;
+            motion["x_y_axis_acceleration"] = x_y_axis_acceleration;
+            motion["x_y_axis_jerk"] = x_y_axis_jerk;
+
+            JsonObject sampling = data.createNestedObject("sampling");
+            sampling["sample_bound"] = sample_bound;
+            sampling["sample_min"] = sample_min;
+            sampling["sample_max"] = sample_max;
+
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+            int16_t zone_offsets[VL53_ZONE_COUNT];
+            get_zone_offsets(zone_offsets, VL53_ZONE_COUNT);
+            JsonArray zones = sampling.createNestedArray("zone_offsets");
+            for (uint8_t i = 0; i < VL53_ZONE_COUNT; i++) zones.add(zone_offsets[i]);
+#endif
+
+            JsonObject filter = data.createNestedObject("filter");
+            filter["filter_window"] = filter_window;
+            filter["filter_outlier"] = filter_outlier;
+            filter["filter_ring"] = filter_ring;
+            filter["filter_smooth"] = filter_smooth;
+            filter["filter_drop"] = filter_drop;
+            filter["voxel_size"] = voxel_size;
+
+            vl53_sensor_t sensors[VL53_SENSOR_MAX];
+            size_t sensors_length = get_vl53_sensors(sensors, sizeof(sensors));
+            JsonArray sensor_list = data.createNestedArray("sensors");
+            for (uint8_t i = 0; i < sensors_length / sizeof(vl53_sensor_t); i++) {
+                JsonObject sensor = sensor_list.createNestedObject();
+                sensor["xshut"] = sensors[i].xshut_pin;
+                sensor["int"] = sensors[i].int_pin;
+                sensor["center"] = sensors[i].center;
+                sensor["angle"] = sensors[i].angle_steps;
+                sensor["z"] = sensors[i].z_steps;
+            }
+
+            JsonObject stream = data.createNestedObject("stream");
+            stream["batch_points"] = policy.batch_points;
+            stream["batch_bytes"] = policy.batch_bytes;
+            stream["batch_time"] = policy.batch_time;
+            stream["batch_ring"] = policy.batch_ring;
+            stream["status_time"] = policy.status_time;
+
             String response;
             serializeJson(doc, response);
             request->send(200, "application/json", response);
@@ -185,6 +420,68 @@ void init_server() {
                             request->getParam("vl53l1x_center")->value().toInt(), request->getParam("vl53l1x_timeing_budget")->value().toInt());
             }
 
+            if (request->getParam("z_axis_max_speed") != NULL && request->getParam("z_axis_acceleration") != NULL && request->getParam("z_axis_jerk") != NULL &&
+                request->getParam("x_y_axis_max_speed") != NULL && request->getParam("x_y_axis_acceleration") != NULL && request->getParam("x_y_axis_jerk") != NULL) {
+                set_motion(request->getParam("z_axis_max_speed")->value().toInt(), request->getParam("z_axis_acceleration")->value().toInt(), request->getParam("z_axis_jerk")->value().toInt(),
+                            request->getParam("x_y_axis_max_speed")->value().toInt(), request->getParam("x_y_axis_acceleration")->value().toInt(), request->getParam("x_y_axis_jerk")->value().toInt());
+            }
+
+            if (request->getParam("sample_bound") != NULL && request->getParam("sample_min") != NULL && request->getParam("sample_max") != NULL) {
+                set_sampling(request->getParam("sample_bound")->value().toInt(), request->getParam("sample_min")->value().toInt(), request->getParam("sample_max")->value().toInt());
+            }
+
+            if (request->getParam("filter_window") != NULL && request->getParam("filter_outlier") != NULL && request->getParam("filter_ring") != NULL &&
+                request->getParam("filter_smooth") != NULL && request->getParam("filter_drop") != NULL) {
+                set_filter(request->getParam("filter_window")->value().toInt(), request->getParam("filter_outlier")->value().toInt(), request->getParam("filter_ring")->value().toInt(),
+                            request->getParam("filter_smooth")->value().toInt(), request->getParam("filter_drop")->value().toInt());
+            }
+
+            if (request->getParam("voxel_size") != NULL) {
+                set_voxel(request->getParam("voxel_size")->value().toInt());
+            }
+
+#ifdef CONFIG_VL53L1X_MULTI_ZONE
+            {
+                int16_t zone_offsets[VL53_ZONE_COUNT];
+                uint8_t zones = 0;
+                for (; zones < VL53_ZONE_COUNT; zones++) {
+                    AsyncWebParameter* param = request->getParam("zone_offset_" + String(zones));
+                    if (param == NULL) break;
+                    zone_offsets[zones] = param->value().toInt();
+                }
+                if (zones == VL53_ZONE_COUNT) set_zone_offsets(zone_offsets, VL53_ZONE_COUNT);
+            }
+#endif
+
+            if (request->getParam("sensor_count") != NULL) {
+                vl53_sensor_t sensors[VL53_SENSOR_MAX];
+                uint8_t count = constrain(request->getParam("sensor_count")->value().toInt(), 1, VL53_SENSOR_MAX);
+                uint8_t given = 0;
+                for (; given < count; given++) {
+                    String prefix = "sensor_" + String(given) + "_";
+                    if (request->getParam(prefix + "xshut") == NULL || request->getParam(prefix + "int") == NULL || request->getParam(prefix + "center") == NULL ||
+                        request->getParam(prefix + "angle") == NULL || request->getParam(prefix + "z") == NULL) break;
+                    sensors[given].xshut_pin = request->getParam(prefix + "xshut")->value().toInt();
+                    sensors[given].int_pin = request->getParam(prefix + "int")->value().toInt();
+                    sensors[given].center = request->getParam(prefix + "center")->value().toInt();
+                    sensors[given].angle_steps = request->getParam(prefix + "angle")->value().toInt();
+                    sensors[given].z_steps = request->getParam(prefix + "z")->value().toInt();
+                }
+                if (given == count) set_vl53_sensors(sensors, count * sizeof(vl53_sensor_t));
+            }
+
+            if (request->getParam("batch_points") != NULL && request->getParam("batch_bytes") != NULL && request->getParam("batch_time") != NULL &&
+                request->getParam("batch_ring") != NULL && request->getParam("status_time") != NULL) {
+                stream_policy_t policy;
+                policy.batch_points = request->getParam("batch_points")->value().toInt();
+                policy.batch_bytes = request->getParam("batch_bytes")->value().toInt();
+                policy.batch_time = request->getParam("batch_time")->value().toInt();
+                policy.batch_ring = request->getParam("batch_ring")->value().toInt();
+                policy.status_time = request->getParam("status_time")->value().toInt();
+                set_stream(policy.batch_points, policy.batch_bytes, policy.batch_time, policy.batch_ring, policy.status_time);
+                stream_set_policy(&policy);
+            }
+
             request->send(200, "application/json", "{\"code\": 200,\"status\": \"ok\",\"path\": \"/api/set/data\"}");
 
         } catch(const std::exception& e) {
@@ -205,6 +502,9 @@ void init_server() {
                 } else if(command == "new") {
                     if (request->getParam("name") != NULL) {
                         ESP_LOGD(SERVER_TAG, "New command, name: %s", request->getParam("name")->value().c_str());
+                        if (request->getParam("mode") != NULL) set_scan_mode(scan_mode_from_name(request->getParam("mode")->value().c_str()));
+                        if (request->getParam("estimator") != NULL) set_estimator(estimator_from_name(request->getParam("estimator")->value().c_str()));
+                        if (request->getParam("skip") != NULL) set_fast_skip(request->getParam("skip")->value().toInt());
                         set_project_name(request->getParam("name")->value().c_str());
                         set_command(SCANNER_COMMAND_START);
                     } else {
@@ -213,7 +513,13 @@ void init_server() {
                     }
                 } else if(command == "start") {
                     ESP_LOGD(SERVER_TAG, "Start command");
+                    if (request->getParam("mode") != NULL) set_scan_mode(scan_mode_from_name(request->getParam("mode")->value().c_str()));
+                    if (request->getParam("estimator") != NULL) set_estimator(estimator_from_name(request->getParam("estimator")->value().c_str()));
+                    if (request->getParam("skip") != NULL) set_fast_skip(request->getParam("skip")->value().toInt());
                     set_command(SCANNER_COMMAND_START);
+                } else if(command == "resume") {
+                    ESP_LOGD(SERVER_TAG, "Resume command");
+                    set_command(SCANNER_COMMAND_RESUME);
                 } else if(command == "stop") {
                     ESP_LOGD(SERVER_TAG, "Stop command");
                     set_command(SCANNER_COMMAND_STOP);
@@ -273,6 +579,129 @@ void init_server() {
         request->send(code, "application/json", "{\"code\":" + String(code) + ",\"status\": \"" + status + "\",\"path\": \"/api/set/scanner\"}");
     });
 
+    // Before /api/scans, which also takes the paths below it
+    server.on("/api/scans/get", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->getParam("name") == NULL) {
+            request->send(400, "application/json", "{\"code\": 400,\"status\": \"param not found\",\"path\": \"/api/scans/get\"}");
+            return;
+        }
+        if (recorder_filesystem() == NULL) {
+            request->send(503, "application/json", "{\"code\": 503,\"status\": \"no SD card\",\"path\": \"/api/scans/get\"}");
+            return;
+        }
+
+        catalog_entry_t entry;
+        if (!catalog_get(request->getParam("name")->value().c_str(), &entry)) {
+            request->send(404, "application/json", "{\"code\": 404,\"status\": \"scan not found\",\"path\": \"/api/scans/get\"}");
+            return;
+        }
+
+        JsonDocument doc;
+        doc["code"] = 200;
+        doc["status"] = "ok";
+        doc["path"] = "/api/scans/get";
+        scan_entry_json(doc.createNestedObject("data"), &entry, true);
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    server.on("/api/scans/delete", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->getParam("name") == NULL) {
+            request->send(400, "application/json", "{\"code\": 400,\"status\": \"param not found\",\"path\": \"/api/scans/delete\"}");
+            return;
+        }
+        if (recorder_filesystem() == NULL) {
+            request->send(503, "application/json", "{\"code\": 503,\"status\": \"no SD card\",\"path\": \"/api/scans/delete\"}");
+            return;
+        }
+
+        uint8_t result = catalog_remove(request->getParam("name")->value().c_str());
+        if (result == CATALOG_REMOVE_OK) {
+            request->send(200, "application/json", "{\"code\": 200,\"status\": \"ok\",\"path\": \"/api/scans/delete\"}");
+        } else if (result == CATALOG_REMOVE_NOT_FOUND) {
+            request->send(404, "application/json", "{\"code\": 404,\"status\": \"scan not found\",\"path\": \"/api/scans/delete\"}");
+        } else if (result == CATALOG_REMOVE_BUSY) {
+            request->send(409, "application/json", "{\"code\": 409,\"status\": \"scan is recording\",\"path\": \"/api/scans/delete\"}");
+        } else {
+            request->send(500, "application/json", "{\"code\": 500,\"status\": \"Server Error\",\"path\": \"/api/scans/delete\"}");
+        }
+    });
+
+    server.on("/api/scans", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (recorder_filesystem() == NULL) {
+            request->send(503, "application/json", "{\"code\": 503,\"status\": \"no SD card\",\"path\": \"/api/scans\"}");
+            return;
+        }
+
+        scans_list_t* scans = new scans_list_t();
+        catalog_list_begin(&scans->list);
+        scans->part = 0;
+        scans->first = true;
+        scans->pending_length = 0;
+        scans->pending_sent = 0;
+        request->onDisconnect([scans]() {
+            delete scans;
+        });
+
+        AsyncWebServerResponse *response = request->beginChunkedResponse("application/json", [scans](uint8_t *buffer, size_t max_length, size_t index) -> size_t {
+            return scans_list_read(scans, buffer, max_length);
+        });
+        request->send(response);
+    });
+
+    server.on("/api/scan/export", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->getParam("name") == NULL) {
+            request->send(400, "application/json", "{\"code\": 400,\"status\": \"param not found\",\"path\": \"/api/scan/export\"}");
+            return;
+        }
+        if (recorder_filesystem() == NULL) {
+            request->send(503, "application/json", "{\"code\": 503,\"status\": \"no SD card\",\"path\": \"/api/scan/export\"}");
+            return;
+        }
+
+        uint8_t format = exporter_format_from_name(request->getParam("format") != NULL ? request->getParam("format")->value().c_str() : NULL);
+        exporter_t* exporter = new exporter_t();
+        if (!exporter_open(exporter, request->getParam("name")->value().c_str(), format)) {
+            delete exporter;
+            request->send(404, "application/json", "{\"code\": 404,\"status\": \"scan not found\",\"path\": \"/api/scan/export\"}");
+            return;
+        }
+        // The response may still read while the request goes away, so the download is freed with the connection
+        request->onDisconnect([exporter]() {
+            exporter_close(exporter);
+            delete exporter;
+        });
+
+        AsyncWebServerResponse *response;
+        size_t length = exporter_length(exporter);
+        if (length > 0) {
+            size_t start, end;
+            int code = export_range(request, length, &start, &end);
+            if (code == 416) {
+                response = request->beginResponse(416, "application/json", "{\"code\": 416,\"status\": \"range not satisfiable\",\"path\": \"/api/scan/export\"}");
+                response->addHeader("Content-Range", "bytes */" + String(length));
+                request->send(response);
+                return;
+            }
+            response = request->beginResponse(exporter_content_type(format), end - start + 1, [exporter, start](uint8_t *buffer, size_t max_length, size_t index) -> size_t {
+                return exporter_read(exporter, buffer, max_length, start + index);
+            });
+            response->setCode(code);
+            response->addHeader("Accept-Ranges", "bytes");
+            if (code == 206) response->addHeader("Content-Range", "bytes " + String(start) + "-" + String(end) + "/" + String(length));
+        } else {
+            // Text sizes are only known at the end
+            response = request->beginChunkedResponse(exporter_content_type(format), [exporter](uint8_t *buffer, size_t max_length, size_t index) -> size_t {
+                return exporter_read(exporter, buffer, max_length, index);
+            });
+            response->addHeader("Accept-Ranges", "none");
+        }
+        response->addHeader("Content-Disposition", "attachment; filename=\"" + request->getParam("name")->value() + "." + exporter_extension(format) + "\"");
+        request->send(response);
+    });
+
     server.on("/api/ota", HTTP_GET, [](AsyncWebServerRequest *request) {
         try{
             if (request->getParam("username") != NULL && request->getParam("repo") != NULL && request->getParam("id") != NULL) {
@@ -306,4 +735,145 @@ void init_server() {
 
 void ws_send_text(const char* message) {
     ws.textAll(message);
-}
\ No newline at end of file
+}
+
+void ws_set_client_format(uint32_t id, uint8_t format) {
+    portENTER_CRITICAL(&ws_clients_mux);
+    uint8_t i = 0;
+    while (i < ws_client_count && ws_clients[i].id != id) i++;
+    if (i == ws_client_count && ws_client_count < WS_MAX_CLIENTS) ws_client_count++;
+    if (i < ws_client_count) {
+        if (ws_clients[i].id != id) ws_clients[i].replay = false;
+        ws_clients[i].id = id;
+        ws_clients[i].format = format;
+    }
+    portEXIT_CRITICAL(&ws_clients_mux);
+    ESP_LOGD(SERVER_TAG, "WebSocket client #%u format: %u", id, format);
+}
+
+void ws_remove_client(uint32_t id) {
+    portENTER_CRITICAL(&ws_clients_mux);
+    for (uint8_t i = 0; i < ws_client_count; i++) {
+        if (ws_clients[i].id == id) {
+            ws_clients[i] = ws_clients[--ws_client_count];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&ws_clients_mux);
+}
+
+bool ws_has_clients(uint8_t format) {
+    bool found = false;
+    portENTER_CRITICAL(&ws_clients_mux);
+    for (uint8_t i = 0; i < ws_client_count && !found; i++) {
+        found = ws_clients[i].format == format;
+    }
+    portEXIT_CRITICAL(&ws_clients_mux);
+    return found;
+}
+
+/**
+ * @brief Send a point frame to the clients that picked `format` and are not replaying
+ *
+ * @param format `uint8_t`: `STREAM_FORMAT_JSON` goes out as text, the others as binary
+ * @param data `const uint8_t*`: the frame
+ * @param len `size_t`: the frame length
+ */
+void ws_send_frame(uint8_t format, const uint8_t* data, size_t len) {
+    uint32_t ids[WS_MAX_CLIENTS];
+    uint8_t count = 0;
+
+    portENTER_CRITICAL(&ws_clients_mux);
+    for (uint8_t i = 0; i < ws_client_count; i++) {
+        if (ws_clients[i].format == format && !ws_clients[i].replay) ids[count++] = ws_clients[i].id;
+    }
+    portEXIT_CRITICAL(&ws_clients_mux);
+
+    for (uint8_t i = 0; i < count; i++) {
+        AsyncWebSocketClient* client = ws.client(ids[i]);
+        if (client == NULL || client->status() != WS_CONNECTED) continue;
+        if (format == STREAM_FORMAT_JSON) {
+            client->text((const char*)data, len);
+        } else {
+            client->binary(data, len);
+        }
+    }
+}
+
+/**
+ * @brief Send a frame to one client, a replay or a message about it
+ *
+ * @param id `uint32_t`: the client
+ * @param format `uint8_t`: `STREAM_FORMAT_JSON` goes out as text, the others as binary
+ * @param data `const uint8_t*`: the frame
+ * @param len `size_t`: the frame length
+ */
+void ws_send_client_frame(uint32_t id, uint8_t format, const uint8_t* data, size_t len) {
+    AsyncWebSocketClient* client = ws.client(id);
+    if (client == NULL || client->status() != WS_CONNECTED) return;
+    if (format == STREAM_FORMAT_JSON) {
+        client->text((const char*)data, len);
+    } else {
+        client->binary(data, len);
+    }
+}
+
+/**
+ * @brief Whether a client takes more frames
+ *
+ * @param id `uint32_t`: the client
+ * @return `uint8_t`: `WS_CLIENT_FULL` while its send queue is full, `WS_CLIENT_GONE` once it left
+ */
+uint8_t ws_client_state(uint32_t id) {
+    AsyncWebSocketClient* client = ws.client(id);
+    if (client == NULL || client->status() != WS_CONNECTED) return WS_CLIENT_GONE;
+    return client->queueIsFull() ? WS_CLIENT_FULL : WS_CLIENT_READY;
+}
+
+/**
+ * @brief Hold the live frames of a client until it got the points after `seq` again
+ *
+ * @param id `uint32_t`: the client
+ * @param seq `uint32_t`: the last point the client has, `0` for the whole scan
+ */
+void ws_request_replay(uint32_t id, uint32_t seq) {
+    bool found = false;
+    portENTER_CRITICAL(&ws_clients_mux);
+    for (uint8_t i = 0; i < ws_client_count; i++) {
+        if (ws_clients[i].id == id) {
+            ws_clients[i].replay = true;
+            ws_clients[i].replay_seq = seq;
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&ws_clients_mux);
+    if (found) stream_replay_notify();
+}
+
+/**
+ * @brief The next client waiting for a replay, called by the stream task
+ *
+ * @return `bool`: `false` if no client waits
+ */
+bool ws_next_replay(uint32_t* id, uint8_t* format, uint32_t* seq) {
+    bool found = false;
+    portENTER_CRITICAL(&ws_clients_mux);
+    for (uint8_t i = 0; i < ws_client_count && !found; i++) {
+        if (!ws_clients[i].replay) continue;
+        *id = ws_clients[i].id;
+        *format = ws_clients[i].format;
+        *seq = ws_clients[i].replay_seq;
+        found = true;
+    }
+    portEXIT_CRITICAL(&ws_clients_mux);
+    return found;
+}
+
+void ws_end_replay(uint32_t id) {
+    portENTER_CRITICAL(&ws_clients_mux);
+    for (uint8_t i = 0; i < ws_client_count; i++) {
+        if (ws_clients[i].id == id) ws_clients[i].replay = false;
+    }
+    portEXIT_CRITICAL(&ws_clients_mux);
+}
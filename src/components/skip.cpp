@@ -0,0 +1,48 @@
+// Path: src/components/skip.cpp
+#include "components/skip.h"    // include/components/skip.h
+
+const char* SKIP_TAG = SKIP_TAG_NAME;
+
+/**
+ * @brief Start a ring, points are taken one by one until `SKIP_AFTER` of them in a row are empty
+ *
+ * @param skip `skip_t*`: the skip
+ * @param stride `uint16_t`: points of a stride, `0` or `1` is off
+ */
+void skip_begin(skip_t* skip, uint16_t stride) {
+    skip->stride = stride;
+    skip->empty_run = 0;
+    skip->active = false;
+    skip->hold = 0;
+}
+
+/**
+ * @brief Judge the point just ranged
+ *
+ * The surface at the end of a stride sends the turntable back to scan the stride point by point. The empty points
+ * before the surface do not start a new stride, or it would jump past the surface again.
+ *
+ * @param skip `skip_t*`: the skip
+ * @param position `uint32_t`: the turntable position of the point
+ * @param surface `bool`: the point sees the surface
+ * @return `uint16_t`: the points to go back, `0` to keep the point
+ */
+uint16_t skip_check(skip_t* skip, uint32_t position, bool surface) {
+    if (skip->active && surface) {
+        ESP_LOGD(SKIP_TAG, "Surface at: %u, back: %u points", position, skip->stride - 1);
+        skip->active = false;
+        skip->empty_run = 0;
+        skip->hold = position;
+        return skip->stride - 1;
+    }
+    skip->empty_run = surface ? 0 : skip->empty_run + 1;
+    if (skip->stride > 1 && skip->empty_run >= SKIP_AFTER && position > skip->hold) skip->active = true;
+    return 0;
+}
+
+/**
+ * @brief Points of the next move
+ */
+uint16_t skip_points(const skip_t* skip) {
+    return skip->active ? skip->stride : 1;
+}
@@ -0,0 +1,249 @@
+// Path: src/components/stepper.cpp
+#include "components/stepper.h"    // include/components/stepper.h
+
+const char* STEPPER_TAG = STEPPER_TAG_NAME;
+
+stepper_axis_t stepper_axes[STEPPER_AXIS_COUNT];
+// Moves are started and stopped from any task while the timer ISR steps the axis
+portMUX_TYPE stepper_mux[STEPPER_AXIS_COUNT] = { portMUX_INITIALIZER_UNLOCKED, portMUX_INITIALIZER_UNLOCKED };
+
+/**
+ * @brief Advance one half period of the step signal
+ *
+ * The drivers latch a step on the rising edge, so the position is counted there.
+ * Kept free of hardware access so the pulse timeline can be replayed off target.
+ *
+ * @param axis `stepper_axis_t*`: the axis state
+ * @param home_active `bool`: the home switch is pressed
+ * @return `bool`: the timer must keep running
+ */
+bool IRAM_ATTR stepper_next_edge(stepper_axis_t* axis, bool home_active) {
+    if (axis->level) {
+        axis->level = false;
+        if (axis->remaining == 0) {
+            axis->segment_index++;
+            if (axis->segment_index >= axis->segment_count) {
+                axis->busy = false;
+                return false;
+            }
+            axis->remaining = axis->segments[axis->segment_index].steps;
+            axis->half_period_us = axis->segments[axis->segment_index].half_period_us;
+        }
+        return true;
+    }
+
+    if (axis->remaining == 0 ||
+        ( axis->direction && axis->position >= axis->max_position ) ||
+        ( !axis->direction && ( home_active || axis->position <= axis->min_position ) )) {
+        axis->remaining = 0;
+        axis->busy = false;
+        return false;
+    }
+
+    axis->level = true;
+    axis->position += axis->direction ? 1 : -1;
+    axis->remaining--;
+    return true;
+}
+
+static bool IRAM_ATTR stepper_timer_isr(void* arg) {
+    stepper_axis_t* axis = (stepper_axis_t*)arg;
+    portMUX_TYPE* mux = &stepper_mux[axis - stepper_axes];
+    bool home_active = axis->home_pin != STEPPER_NO_HOME_PIN && digitalRead(axis->home_pin) == axis->home_level;
+
+    portENTER_CRITICAL_ISR(mux);
+    // A stop that got the lock first leaves nothing to step
+    bool running = axis->busy && stepper_next_edge(axis, home_active);
+    digitalWrite(axis->step_pin, axis->level);
+
+    if (running) {
+        timer_group_set_alarm_value_in_isr(axis->timer_group, axis->timer_idx, axis->half_period_us);
+    } else {
+        timer_group_set_counter_enable_in_isr(axis->timer_group, axis->timer_idx, TIMER_PAUSE);
+    }
+    portEXIT_CRITICAL_ISR(mux);
+    return false;
+}
+
+/**
+ * @brief Initialize the step generator of an axis
+ *
+ * Each axis owns one general purpose timer of group 0 that ticks every microsecond.
+ *
+ * @param axis `uint8_t`: `STEPPER_AXIS_Z` or `STEPPER_AXIS_X_Y`
+ * @param step_pin `uint8_t`: the driver STEP pin
+ * @param dir_pin `uint8_t`: the driver DIR pin
+ */
+void stepper_init(uint8_t axis, uint8_t step_pin, uint8_t dir_pin) {
+    if (axis >= STEPPER_AXIS_COUNT) return;
+
+    stepper_axis_t* a = &stepper_axes[axis];
+    a->step_pin = step_pin;
+    a->dir_pin = dir_pin;
+    a->home_pin = STEPPER_NO_HOME_PIN;
+    a->home_level = LOW;
+    a->timer_group = TIMER_GROUP_0;
+    a->timer_idx = axis == STEPPER_AXIS_Z ? TIMER_0 : TIMER_1;
+    a->min_position = INT32_MIN;
+    a->max_position = INT32_MAX;
+    a->segment_count = 0;
+    a->segment_index = 0;
+    a->position = 0;
+    a->remaining = 0;
+    a->half_period_us = 0;
+    a->direction = false;
+    a->level = false;
+    a->busy = false;
+
+    pinMode(step_pin, OUTPUT);
+    pinMode(dir_pin, OUTPUT);
+    digitalWrite(step_pin, LOW);
+
+    timer_config_t config = {
+        .alarm_en = TIMER_ALARM_EN,
+        .counter_en = TIMER_PAUSE,
+        .intr_type = TIMER_INTR_LEVEL,
+        .counter_dir = TIMER_COUNT_UP,
+        .auto_reload = TIMER_AUTORELOAD_EN,
+        .divider = STEPPER_TIMER_DIVIDER,
+    };
+
+    esp_err_t err = timer_init(a->timer_group, a->timer_idx, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(STEPPER_TAG, "Error (%s) initializing axis %u timer", esp_err_to_name(err), axis);
+        return;
+    }
+    timer_set_counter_value(a->timer_group, a->timer_idx, 0);
+    timer_enable_intr(a->timer_group, a->timer_idx);
+    timer_isr_callback_add(a->timer_group, a->timer_idx, stepper_timer_isr, a, 0);
+}
+
+/**
+ * @brief Set the soft limits and the home switch of an axis
+ *
+ * @param axis `uint8_t`: the axis
+ * @param min_position `int32_t`: no step below this position
+ * @param max_position `int32_t`: no step above this position
+ * @param home_pin `uint8_t`: the home switch pin, checked when moving down, default is `STEPPER_NO_HOME_PIN`
+ * @param home_level `uint8_t`: the level of the pressed home switch, default is `LOW`
+ */
+void stepper_set_limit(uint8_t axis, int32_t min_position, int32_t max_position, uint8_t home_pin, uint8_t home_level) {
+    if (axis >= STEPPER_AXIS_COUNT) return;
+    stepper_axes[axis].min_position = min_position;
+    stepper_axes[axis].max_position = max_position;
+    stepper_axes[axis].home_pin = home_pin;
+    stepper_axes[axis].home_level = home_level;
+}
+
+/**
+ * @brief Start a move in the background
+ *
+ * @param axis `uint8_t`: the axis
+ * @param direction `bool`: `HIGH` counts the position up, `LOW` counts it down
+ * @param steps `uint32_t`: the number of steps
+ * @param half_period_us `uint32_t`: the time the STEP pin stays high and low
+ * @return `bool`: `false` if the axis is still busy
+ */
+bool stepper_move(uint8_t axis, bool direction, uint32_t steps, uint32_t half_period_us) {
+    stepper_segment_t segment = { steps, half_period_us };
+    return stepper_move_segments(axis, direction, &segment, 1);
+}
+
+/**
+ * @brief Start a move made of constant rate segments in the background
+ *
+ * The rate is switched inside the timer ISR, so the segments run back to back without a gap.
+ *
+ * @param axis `uint8_t`: the axis
+ * @param direction `bool`: `HIGH` counts the position up, `LOW` counts it down
+ * @param segments `const stepper_segment_t*`: the segments, empty ones are skipped
+ * @param count `uint8_t`: the number of segments, up to `STEPPER_MAX_SEGMENTS`
+ * @return `bool`: `false` if the axis is still busy
+ */
+bool stepper_move_segments(uint8_t axis, bool direction, const stepper_segment_t* segments, uint8_t count) {
+    if (axis >= STEPPER_AXIS_COUNT) return false;
+
+    stepper_axis_t* a = &stepper_axes[axis];
+    portENTER_CRITICAL(&stepper_mux[axis]);
+    if (a->busy) {
+        portEXIT_CRITICAL(&stepper_mux[axis]);
+        ESP_LOGW(STEPPER_TAG, "Axis %u is busy", axis);
+        return false;
+    }
+
+    a->segment_count = 0;
+    for (uint8_t i = 0; i < count && a->segment_count < STEPPER_MAX_SEGMENTS; i++) {
+        if (segments[i].steps == 0) continue;
+        a->segments[a->segment_count] = segments[i];
+        if (a->segments[a->segment_count].half_period_us < STEPPER_MIN_HALF_PERIOD_US) {
+            a->segments[a->segment_count].half_period_us = STEPPER_MIN_HALF_PERIOD_US;
+        }
+        a->segment_count++;
+    }
+    if (a->segment_count == 0) {
+        portEXIT_CRITICAL(&stepper_mux[axis]);
+        return true;
+    }
+
+    digitalWrite(a->dir_pin, direction);
+    a->direction = direction;
+    a->segment_index = 0;
+    a->remaining = a->segments[0].steps;
+    a->half_period_us = a->segments[0].half_period_us;
+    a->level = false;
+    a->busy = true;
+
+    timer_set_counter_value(a->timer_group, a->timer_idx, 0);
+    timer_set_alarm_value(a->timer_group, a->timer_idx, a->half_period_us);
+    timer_start(a->timer_group, a->timer_idx);
+    portEXIT_CRITICAL(&stepper_mux[axis]);
+    return true;
+}
+
+/**
+ * @brief Abort the move of an axis, the position stays valid
+ *
+ * Safe to call from any task, the ISR never steps past a stop.
+ *
+ * @param axis `uint8_t`: the axis
+ */
+void stepper_stop(uint8_t axis) {
+    if (axis >= STEPPER_AXIS_COUNT) return;
+
+    stepper_axis_t* a = &stepper_axes[axis];
+    portENTER_CRITICAL(&stepper_mux[axis]);
+    timer_pause(a->timer_group, a->timer_idx);
+    a->remaining = 0;
+    a->level = false;
+    a->busy = false;
+    digitalWrite(a->step_pin, LOW);
+    portEXIT_CRITICAL(&stepper_mux[axis]);
+}
+
+/**
+ * @brief Block the calling task until the axis is idle
+ *
+ * @param axis `uint8_t`: the axis
+ */
+void stepper_wait(uint8_t axis) {
+    while (stepper_is_busy(axis)) {
+        vTaskDelay(1);
+    }
+}
+
+bool stepper_is_busy(uint8_t axis) {
+    if (axis >= STEPPER_AXIS_COUNT) return false;
+    return stepper_axes[axis].busy;
+}
+
+int32_t stepper_get_position(uint8_t axis) {
+    if (axis >= STEPPER_AXIS_COUNT) return 0;
+    return stepper_axes[axis].position;
+}
+
+void stepper_set_position(uint8_t axis, int32_t position) {
+    if (axis >= STEPPER_AXIS_COUNT) return;
+    portENTER_CRITICAL(&stepper_mux[axis]);
+    stepper_axes[axis].position = position;
+    portEXIT_CRITICAL(&stepper_mux[axis]);
+}
@@ -0,0 +1,619 @@
+// Path: src/components/stream.cpp
+#include "components/stream.h"    // include/components/stream.h
+
+#include "components/module.h"
+#include "components/server.h"
+
+const char* STREAM_TAG = STREAM_TAG_NAME;
+
+TaskHandle_t stream_task_handle = NULL;
+
+portMUX_TYPE stream_mux = portMUX_INITIALIZER_UNLOCKED;
+char stream_name[SCANNER_PROJECT_NAME_LENGTH] = "";
+stream_policy_t stream_policy = {
+    NVS_STREAM_BATCH_POINTS_DEFAULT, NVS_STREAM_BATCH_BYTES_DEFAULT, NVS_STREAM_BATCH_TIME_DEFAULT,
+    NVS_STREAM_BATCH_RING_DEFAULT, NVS_STREAM_STATUS_TIME_DEFAULT
+};
+
+scanner_point_t stream_batch[STREAM_BATCH_MAX_POINTS];
+size_t stream_batch_count = 0;
+unsigned long stream_batch_time = 0;
+
+// Owned by the stream task: the points sent last, oldest first from stream_kept_start, and the replay being sent
+scanner_point_t stream_kept[STREAM_REPLAY_POINTS];
+size_t stream_kept_start = 0;
+size_t stream_kept_count = 0;
+stream_replay_t stream_replay;
+scanner_point_t stream_replay_batch[STREAM_BATCH_MAX_POINTS];
+recorder_record_t stream_replay_records[STREAM_REPLAY_RECORDS];
+
+void stream_task(void* parameter);
+void stream_send_batch();
+size_t stream_batch_bytes(size_t count);
+void stream_send_points(uint32_t client, uint8_t format, const scanner_point_t* points, size_t count);
+void stream_send_json(uint32_t client, const scanner_point_t* points, size_t count);
+void stream_send_binary(uint32_t client, uint8_t format, const scanner_point_t* points, size_t count);
+void stream_send_ring(uint32_t client, uint8_t format, const scanner_point_t* points, size_t count);
+void stream_send_frame(uint32_t client, uint8_t format, const uint8_t* data, size_t len);
+void stream_keep(const scanner_point_t* points, size_t count);
+size_t stream_kept_find(uint32_t seq);
+bool stream_replay_step();
+void stream_replay_begin(uint32_t client, uint8_t format, uint32_t seq);
+void stream_replay_end(bool caught_up);
+size_t stream_replay_read(scanner_point_t* points, size_t max_count);
+size_t stream_replay_read_kept(scanner_point_t* points, size_t max_count);
+size_t stream_replay_read_card(scanner_point_t* points, size_t max_count);
+bool stream_replay_open_card();
+bool stream_frame_break(const scanner_point_t* points, size_t start, size_t end);
+void stream_append_fixed(String& message, int32_t value);
+
+/**
+ * @brief Start the task that drains the point buffer to the WebSocket clients
+ */
+void init_stream() {
+    stream_policy_t policy;
+    get_stream(&policy.batch_points, &policy.batch_bytes, &policy.batch_time, &policy.batch_ring, &policy.status_time);
+    stream_set_policy(&policy);
+
+    if (xTaskCreatePinnedToCore(stream_task, "stream", STREAM_TASK_STACK_SIZE, NULL, STREAM_TASK_PRIORITY, &stream_task_handle, STREAM_TASK_CORE) != pdPASS) {
+        ESP_LOGE(STREAM_TAG, "Failed to create the stream task");
+    }
+}
+
+/**
+ * @brief Set the project name sent with the points
+ *
+ * @param name `const char*`: the project name
+ */
+void stream_set_name(const char* name) {
+    portENTER_CRITICAL(&stream_mux);
+    strncpy(stream_name, name, SCANNER_PROJECT_NAME_LENGTH - 1);
+    stream_name[SCANNER_PROJECT_NAME_LENGTH - 1] = '\0';
+    portEXIT_CRITICAL(&stream_mux);
+}
+
+/**
+ * @brief Wake the stream task, called by the producer after a push
+ */
+void stream_notify() {
+    if (stream_task_handle != NULL) xTaskNotify(stream_task_handle, STREAM_NOTIFY_POINTS, eSetBits);
+}
+
+/**
+ * @brief Ask the stream task to send the waiting points, called at the end of a ring
+ */
+void stream_flush() {
+    if (stream_task_handle != NULL) xTaskNotify(stream_task_handle, STREAM_NOTIFY_FLUSH, eSetBits);
+}
+
+/**
+ * @brief Wake the stream task to serve a replay a client asked for
+ */
+void stream_replay_notify() {
+    if (stream_task_handle != NULL) xTaskNotify(stream_task_handle, STREAM_NOTIFY_REPLAY, eSetBits);
+}
+
+/**
+ * @brief Set the batch limits, applied from the next point on
+ *
+ * @param policy `const stream_policy_t*`: the limits, `batch_points` is clamped to `STREAM_BATCH_MAX_POINTS`
+ */
+void stream_set_policy(const stream_policy_t* policy) {
+    portENTER_CRITICAL(&stream_mux);
+    stream_policy = *policy;
+    stream_policy.batch_points = constrain(stream_policy.batch_points, 1, STREAM_BATCH_MAX_POINTS);
+    portEXIT_CRITICAL(&stream_mux);
+}
+
+stream_policy_t stream_get_policy() {
+    portENTER_CRITICAL(&stream_mux);
+    stream_policy_t policy = stream_policy;
+    portEXIT_CRITICAL(&stream_mux);
+    return policy;
+}
+
+/**
+ * @brief Collect the points into batches and send a batch once it reaches a limit of the policy, replays go in between
+ */
+void stream_task(void* parameter) {
+    scanner_point_t point;
+    bool replaying = false;
+
+    for (;;) {
+        stream_policy_t policy = stream_get_policy();
+
+        TickType_t wait = pdMS_TO_TICKS(replaying ? STREAM_REPLAY_WAIT_MS : STREAM_IDLE_WAIT_MS);
+        if (stream_batch_count > 0) {
+            unsigned long age = millis() - stream_batch_time;
+            wait = min(wait, age >= policy.batch_time ? 0 : pdMS_TO_TICKS(policy.batch_time - age));
+        }
+
+        uint32_t notify = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &notify, wait);
+
+        while (point_buffer_pop(&point, 1) == 1) {
+            // A batch holds points of one level, the coarse and the fine pass of a refine scan are sent apart
+            if (stream_batch_count > 0 &&
+                (( policy.batch_ring && point_new_ring(&stream_batch[stream_batch_count - 1], &point) ) ||
+                 POINT_LEVEL(point.flags) != POINT_LEVEL(stream_batch[0].flags))) {
+                stream_send_batch();
+            }
+            if (stream_batch_count == 0) stream_batch_time = millis();
+            stream_batch[stream_batch_count++] = point;
+
+            if (stream_batch_count >= policy.batch_points || stream_batch_bytes(stream_batch_count + 1) > policy.batch_bytes) {
+                stream_send_batch();
+            }
+        }
+
+        if (stream_batch_count > 0 &&
+            (( policy.batch_ring && (notify & STREAM_NOTIFY_FLUSH) ) || millis() - stream_batch_time >= policy.batch_time)) {
+            stream_send_batch();
+        }
+
+        replaying = stream_replay_step();
+    }
+}
+
+/**
+ * @brief Frame size of a batch in the largest format a client asked for
+ *
+ * @param count `size_t`: the number of points
+ * @return `size_t`: the size in bytes
+ */
+size_t stream_batch_bytes(size_t count) {
+    if (ws_has_clients(STREAM_FORMAT_JSON)) return STREAM_JSON_HEADER_BYTES + count * STREAM_JSON_POINT_BYTES;
+    return sizeof(stream_frame_header_t) + count * sizeof(stream_frame_dz_point_t);
+}
+
+void stream_send_batch() {
+    stream_keep(stream_batch, stream_batch_count);
+    for (uint8_t format = 0; format < STREAM_FORMAT_COUNT; format++) {
+        if (ws_has_clients(format)) stream_send_points(0, format, stream_batch, stream_batch_count);
+    }
+    stream_batch_count = 0;
+}
+
+/**
+ * @brief Send points in one format
+ *
+ * @param client `uint32_t`: the WebSocket client, `0` for every client of the format that is not replaying
+ * @param format `uint8_t`: `STREAM_FORMAT_*`
+ * @param points `const scanner_point_t*`: the points
+ * @param count `size_t`: the number of points
+ */
+void stream_send_points(uint32_t client, uint8_t format, const scanner_point_t* points, size_t count) {
+    if (format == STREAM_FORMAT_JSON) stream_send_json(client, points, count);
+    else if (format == STREAM_FORMAT_XYZ || format == STREAM_FORMAT_POLAR) stream_send_binary(client, format, points, count);
+    else stream_send_ring(client, format, points, count);
+}
+
+void stream_send_json(uint32_t client, const scanner_point_t* points, size_t count) {
+    char name[SCANNER_PROJECT_NAME_LENGTH];
+    portENTER_CRITICAL(&stream_mux);
+    memcpy(name, stream_name, SCANNER_PROJECT_NAME_LENGTH);
+    portEXIT_CRITICAL(&stream_mux);
+
+    const scanner_point_t* last = &points[count - 1];
+
+    String message;
+    message.reserve(STREAM_JSON_HEADER_BYTES + count * STREAM_JSON_POINT_BYTES);
+    message += "{\"name\":\"";
+    message += name;
+    message += "\",\"status\":\"scan\",\"seq\":" + String(points[0].seq) +
+                ",\"points_count\":" + String(last->seq) +
+                ",\"time\":" + String(last->time_ms / 1000.0) +
+                ",\"is_last\":false" +
+                ",\"z_steps\":" + String(last->z_steps) +
+                ",\"level\":" + String(POINT_LEVEL(last->flags)) +
+                ",\"r\":";
+    stream_append_fixed(message, last->r);
+    message += ",\"points\":[";
+
+    // No surface points have no position, they are only counted
+    size_t no_surface = 0;
+    String suspect;
+    for (size_t i = 0; i < count; i++) {
+        if (points[i].flags & POINT_FLAG_NO_SURFACE) {
+            no_surface++;
+            continue;
+        }
+        if (points[i].flags & POINT_FLAG_SUSPECT) {
+            if (suspect.length() > 0) suspect += ",";
+            suspect += String(i - no_surface);
+        }
+        int32_t x = 0, y = 0;
+        get_x_y(points[i].x_y_steps, points[i].r, &x, &y);
+        message += i > no_surface ? ",[" : "[";
+        stream_append_fixed(message, x);
+        message += ",";
+        stream_append_fixed(message, y);
+        message += ",";
+        stream_append_fixed(message, get_z(points[i].z_steps));
+        message += "]";
+    }
+    message += "],\"no_surface\":" + String(no_surface) +
+               ",\"filtered\":" + String(last->flags & POINT_FLAG_FILTERED ? "true" : "false") +
+               ",\"suspect\":[" + suspect + "]}";
+
+    stream_send_frame(client, STREAM_FORMAT_JSON, (const uint8_t*)message.c_str(), message.length());
+}
+
+/**
+ * @brief Send points as binary frames, a new frame starts with a ring, at a level or quality change or a missing sequence number
+ *
+ * Points that do not share the height of their ring go in the dz frame types, with the height of every point.
+ *
+ * @param client `uint32_t`: the WebSocket client, `0` for every client of the format
+ * @param format `uint8_t`: `STREAM_FORMAT_XYZ` or `STREAM_FORMAT_POLAR`
+ * @param points `const scanner_point_t*`: the points
+ * @param count `size_t`: the number of points
+ */
+void stream_send_binary(uint32_t client, uint8_t format, const scanner_point_t* points, size_t count) {
+    uint8_t frame[sizeof(stream_frame_header_t) + STREAM_BATCH_MAX_POINTS * sizeof(stream_frame_dz_point_t)];
+    stream_frame_header_t* header = (stream_frame_header_t*)frame;
+    uint8_t* body = frame + sizeof(stream_frame_header_t);
+
+    size_t start = 0;
+    while (start < count) {
+        size_t end = start + 1;
+        while (end < count && end - start < STREAM_BATCH_MAX_POINTS && !stream_frame_break(points, start, end)) {
+            end++;
+        }
+
+        bool own_z = points[start].flags & POINT_FLAG_OWN_Z;
+        size_t point_size = own_z ? sizeof(stream_frame_dz_point_t) : sizeof(stream_frame_point_t);
+        if (own_z) {
+            header->type = format == STREAM_FORMAT_XYZ ? STREAM_FRAME_XYZ_DZ : STREAM_FRAME_POLAR_DZ;
+        } else {
+            header->type = format == STREAM_FORMAT_XYZ ? STREAM_FRAME_XYZ : STREAM_FRAME_POLAR;
+        }
+        header->level = POINT_LEVEL(points[start].flags) |
+                        (points[start].flags & POINT_FLAG_FILTERED ? STREAM_LEVEL_FILTERED : 0) |
+                        (points[start].flags & POINT_FLAG_SUSPECT ? STREAM_LEVEL_SUSPECT : 0);
+        header->count = end - start;
+        header->seq = points[start].seq;
+        header->z_steps = points[start].z_steps;
+        header->time_ms = points[start].time_ms;
+
+        for (size_t i = start; i < end; i++) {
+            stream_frame_dz_point_t point;
+            if (points[i].flags & POINT_FLAG_NO_SURFACE) {
+                point.a = format == STREAM_FORMAT_XYZ ? STREAM_XYZ_NO_SURFACE : (int16_t)points[i].x_y_steps;
+                point.b = format == STREAM_FORMAT_XYZ ? STREAM_XYZ_NO_SURFACE : (int16_t)STREAM_POLAR_NO_SURFACE;
+            } else if (format == STREAM_FORMAT_XYZ) {
+                int32_t x = 0, y = 0;
+                get_x_y(points[i].x_y_steps, points[i].r, &x, &y);
+                point.a = (int16_t)constrain(x, INT16_MIN, INT16_MAX);
+                point.b = (int16_t)constrain(y, INT16_MIN, INT16_MAX);
+            } else {
+                point.a = (int16_t)points[i].x_y_steps;
+                point.b = (int16_t)points[i].r;
+            }
+            point.dz = (int16_t)(points[i].z_steps - points[start].z_steps);
+            memcpy(body + (i - start) * point_size, &point, point_size);
+        }
+
+        stream_send_frame(client, format, frame, sizeof(stream_frame_header_t) + (end - start) * point_size);
+        start = end;
+    }
+}
+
+/**
+ * @brief Send points as ring frames, the radius changes are encoded point by point as the frame fills
+ *
+ * A new frame starts where a binary frame would, and where the turntable step between two points changes.
+ *
+ * @param client `uint32_t`: the WebSocket client, `0` for every client of the format
+ * @param format `uint8_t`: `STREAM_FORMAT_RING` or `STREAM_FORMAT_RING_RLE`
+ * @param points `const scanner_point_t*`: the points
+ * @param count `size_t`: the number of points
+ */
+void stream_send_ring(uint32_t client, uint8_t format, const scanner_point_t* points, size_t count) {
+    uint8_t frame[sizeof(stream_frame_header_t) + CODEC_RING_HEADER_BYTES + STREAM_BATCH_MAX_POINTS * CODEC_RING_POINT_BYTES];
+    stream_frame_header_t* header = (stream_frame_header_t*)frame;
+    codec_ring_encoder_t encoder;
+
+    size_t start = 0;
+    while (start < count) {
+        bool own_z = points[start].flags & POINT_FLAG_OWN_Z;
+        bool rle = format == STREAM_FORMAT_RING_RLE && !own_z;
+        codec_ring_begin(&encoder, frame + sizeof(stream_frame_header_t), sizeof(frame) - sizeof(stream_frame_header_t), rle, own_z);
+
+        size_t end = start;
+        while (end < count && (end == start || !stream_frame_break(points, start, end))) {
+            int16_t dz = (int16_t)(points[end].z_steps - points[start].z_steps);
+            if (!codec_ring_add(&encoder, points[end].x_y_steps, points[end].r, dz)) break;
+            end++;
+        }
+
+        header->type = own_z ? STREAM_FRAME_RING_DZ : (rle ? STREAM_FRAME_RING_RLE : STREAM_FRAME_RING);
+        header->level = POINT_LEVEL(points[start].flags) |
+                        (points[start].flags & POINT_FLAG_FILTERED ? STREAM_LEVEL_FILTERED : 0) |
+                        (points[start].flags & POINT_FLAG_SUSPECT ? STREAM_LEVEL_SUSPECT : 0);
+        header->count = end - start;
+        header->seq = points[start].seq;
+        header->z_steps = points[start].z_steps;
+        header->time_ms = points[start].time_ms;
+
+        stream_send_frame(client, format, frame, sizeof(stream_frame_header_t) + codec_ring_end(&encoder));
+        start = end;
+    }
+}
+
+void stream_send_frame(uint32_t client, uint8_t format, const uint8_t* data, size_t len) {
+    if (client == 0) ws_send_frame(format, data, len);
+    else ws_send_client_frame(client, format, data, len);
+}
+
+/**
+ * @brief Keep the points just sent for replays, the oldest make room. A new or resumed scan starts over
+ *
+ * @param points `const scanner_point_t*`: the points, in the order they were sent
+ * @param count `size_t`: the number of points
+ */
+void stream_keep(const scanner_point_t* points, size_t count) {
+    if (count == 0) return;
+    if (stream_kept_count > 0 && points[0].seq <= stream_kept[(stream_kept_start + stream_kept_count - 1) % STREAM_REPLAY_POINTS].seq) {
+        // The seq went back, the points of the replay are gone
+        if (stream_replay.active) stream_replay_end(false);
+        stream_kept_start = 0;
+        stream_kept_count = 0;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (stream_kept_count < STREAM_REPLAY_POINTS) {
+            stream_kept[(stream_kept_start + stream_kept_count++) % STREAM_REPLAY_POINTS] = points[i];
+        } else {
+            stream_kept[stream_kept_start] = points[i];
+            stream_kept_start = (stream_kept_start + 1) % STREAM_REPLAY_POINTS;
+        }
+    }
+}
+
+/**
+ * @brief First kept point at or after `seq`, the seqs of the kept points only grow but may skip dropped points
+ *
+ * @return `size_t`: its place from the oldest kept point, `stream_kept_count` if all are before `seq`
+ */
+size_t stream_kept_find(uint32_t seq) {
+    size_t low = 0;
+    size_t high = stream_kept_count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (stream_kept[(stream_kept_start + mid) % STREAM_REPLAY_POINTS].seq < seq) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+/**
+ * @brief Send the next slice of the replay, or start the replay a client asked for
+ *
+ * @return `bool`: `true` while a replay is on, so the stream task comes back soon
+ */
+bool stream_replay_step() {
+    if (!stream_replay.active) {
+        uint32_t client, seq;
+        uint8_t format;
+        if (!ws_next_replay(&client, &format, &seq)) return false;
+        stream_replay_begin(client, format, seq);
+    }
+
+    for (uint8_t i = 0; i < STREAM_REPLAY_SLICE; i++) {
+        uint8_t state = ws_client_state(stream_replay.client);
+        if (state == WS_CLIENT_GONE) {
+            stream_replay_end(false);
+            return true;
+        }
+        if (state == WS_CLIENT_FULL) return true;
+
+        size_t count = stream_replay_read(stream_replay_batch, STREAM_BATCH_MAX_POINTS);
+        if (count == 0) {
+            stream_replay_end(true);
+            return true;
+        }
+        stream_send_points(stream_replay.client, stream_replay.format, stream_replay_batch, count);
+        stream_replay.last = stream_replay_batch[count - 1].seq;
+    }
+    return true;
+}
+
+/**
+ * @brief Start a replay, the client is told where it starts
+ *
+ * @param client `uint32_t`: the WebSocket client
+ * @param format `uint8_t`: the format of the client
+ * @param seq `uint32_t`: the last point the client has, `0` for the whole scan
+ */
+void stream_replay_begin(uint32_t client, uint8_t format, uint32_t seq) {
+    stream_replay.active = true;
+    stream_replay.client = client;
+    stream_replay.format = format;
+    stream_replay.seq = seq + 1;
+    stream_replay.last = seq;
+    stream_replay.lost = 0;
+    stream_replay_open_card();
+
+    char name[SCANNER_PROJECT_NAME_LENGTH];
+    portENTER_CRITICAL(&stream_mux);
+    memcpy(name, stream_name, SCANNER_PROJECT_NAME_LENGTH);
+    portEXIT_CRITICAL(&stream_mux);
+
+    String message = String("{\"name\":\"") + name + "\",\"status\":\"replay\",\"seq\":" + String(stream_replay.seq) + "}";
+    ws_send_client_frame(client, STREAM_FORMAT_JSON, (const uint8_t*)message.c_str(), message.length());
+    ESP_LOGI(STREAM_TAG, "Replay to client #%u from point %u", client, stream_replay.seq);
+}
+
+/**
+ * @brief End the replay, a client that caught up gets the live points from here on
+ *
+ * @param caught_up `bool`: `false` if the client left or the scan started over
+ */
+void stream_replay_end(bool caught_up) {
+    if (stream_replay.file) stream_replay.file.close();
+    stream_replay.active = false;
+
+    if (caught_up || ws_client_state(stream_replay.client) != WS_CLIENT_GONE) {
+        String message = String("{\"status\":\"replay_end\",\"points_count\":") + String(stream_replay.last) +
+                         ",\"lost\":" + String(stream_replay.lost) + "}";
+        ws_send_client_frame(stream_replay.client, STREAM_FORMAT_JSON, (const uint8_t*)message.c_str(), message.length());
+    }
+    ws_end_replay(stream_replay.client);
+    ESP_LOGI(STREAM_TAG, "Replay to client #%u ended at point %u, lost: %u", stream_replay.client, stream_replay.last, stream_replay.lost);
+}
+
+/**
+ * @brief Next batch of the replay: recorded points older than the kept ones, then the kept ones
+ *
+ * A batch holds points of one level, like a live batch. Points neither kept nor recorded are counted as lost.
+ *
+ * @param points `scanner_point_t*`: the batch
+ * @param max_count `size_t`: the room of the batch
+ * @return `size_t`: the number of points, `0` once the replay reached the last point sent
+ */
+size_t stream_replay_read(scanner_point_t* points, size_t max_count) {
+    if (stream_kept_count == 0 || stream_replay.seq < stream_kept[stream_kept_start].seq) {
+        if (stream_replay.file) {
+            size_t count = stream_replay_read_card(points, max_count);
+            if (count > 0) return count;
+            stream_replay.file.close();
+        }
+        if (stream_kept_count == 0) return 0;
+    }
+    return stream_replay_read_kept(points, max_count);
+}
+
+size_t stream_replay_read_kept(scanner_point_t* points, size_t max_count) {
+    size_t count = 0;
+    for (size_t i = stream_kept_find(stream_replay.seq); i < stream_kept_count && count < max_count; i++) {
+        const scanner_point_t* point = &stream_kept[(stream_kept_start + i) % STREAM_REPLAY_POINTS];
+        if (count > 0 && POINT_LEVEL(point->flags) != POINT_LEVEL(points[0].flags)) break;
+        points[count++] = *point;
+        stream_replay.lost += point->seq - stream_replay.seq;
+        stream_replay.seq = point->seq + 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Read the next recorded points before the oldest kept point
+ *
+ * @return `size_t`: the number of points, `0` once the recording has no more of them
+ */
+size_t stream_replay_read_card(scanner_point_t* points, size_t max_count) {
+    uint32_t limit = stream_kept_count > 0 ? stream_kept[stream_kept_start].seq : UINT32_MAX;
+    size_t count = 0;
+    while (count < max_count && stream_replay.record < stream_replay.records) {
+        uint32_t length = min((uint32_t)STREAM_REPLAY_RECORDS, stream_replay.records - stream_replay.record);
+        // The file shows what was on the card when it was opened, the kept points cover the rest
+        if (!stream_replay.file.seek(RECORDER_HEADER_SIZE + stream_replay.record * sizeof(recorder_record_t))) break;
+        length = stream_replay.file.read((uint8_t*)stream_replay_records, length * sizeof(recorder_record_t)) / sizeof(recorder_record_t);
+        if (length == 0) break;
+
+        for (uint32_t i = 0; i < length && count < max_count; i++) {
+            const recorder_record_t* record = &stream_replay_records[i];
+            if (record->seq >= limit) {
+                stream_replay.records = stream_replay.record;
+                break;
+            }
+            if (count > 0 && POINT_LEVEL(record->flags) != POINT_LEVEL(points[0].flags)) return count;
+            stream_replay.record++;
+            if (record->seq < stream_replay.seq) continue;
+
+            scanner_point_t* point = &points[count++];
+            point->seq = record->seq;
+            point->time_ms = record->time_ms;
+            point->z_steps = record->z_steps;
+            point->x_y_steps = record->x_y_steps;
+            point->r = record->r;
+            point->flags = record->flags;
+            stream_replay.lost += record->seq - stream_replay.seq;
+            stream_replay.seq = record->seq + 1;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Open the SD recording of the scan and find the first record of the replay, a binary search on the seqs
+ *
+ * @return `bool`: `false` without SD card or recording, the replay starts at the oldest kept point
+ */
+bool stream_replay_open_card() {
+    fs::FS* fs = recorder_filesystem();
+    char name[SCANNER_PROJECT_NAME_LENGTH];
+    portENTER_CRITICAL(&stream_mux);
+    memcpy(name, stream_name, SCANNER_PROJECT_NAME_LENGTH);
+    portEXIT_CRITICAL(&stream_mux);
+    if (fs == NULL || name[0] == '\0') return false;
+    // Nothing older than the kept points is needed
+    if (stream_kept_count > 0 && stream_replay.seq >= stream_kept[stream_kept_start].seq) return false;
+
+    String path = recorder_path(name) + ".bin";
+    if (!fs->exists(path.c_str())) return false;
+    stream_replay.file = fs->open(path.c_str(), FILE_READ);
+    if (!stream_replay.file) return false;
+
+    recorder_header_t header;
+    if (stream_replay.file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, RECORDER_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(recorder_record_t) || header.header_size != RECORDER_HEADER_SIZE) {
+        stream_replay.file.close();
+        return false;
+    }
+
+    uint32_t low = 0;
+    uint32_t high = header.records;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t seq = 0;
+        stream_replay.file.seek(RECORDER_HEADER_SIZE + mid * sizeof(recorder_record_t));
+        if (stream_replay.file.read((uint8_t*)&seq, sizeof(seq)) != sizeof(seq)) {
+            high = mid;
+            continue;
+        }
+        if (seq < stream_replay.seq) low = mid + 1;
+        else high = mid;
+    }
+    stream_replay.record = low;
+    stream_replay.records = header.records;
+    return true;
+}
+
+/**
+ * @brief `points[end]` can not share the frame of `points[start]`
+ *
+ * The Z axis steps of a point differ from those of the frame by an `int16` dz at most.
+ */
+bool stream_frame_break(const scanner_point_t* points, size_t start, size_t end) {
+    int32_t dz = (int32_t)(points[end].z_steps - points[start].z_steps);
+    return dz < INT16_MIN || dz > INT16_MAX ||
+           point_new_ring(&points[end - 1], &points[end]) ||
+           POINT_LEVEL(points[end].flags) != POINT_LEVEL(points[start].flags) ||
+           POINT_QUALITY(points[end].flags) != POINT_QUALITY(points[start].flags) ||
+           (points[end].flags & POINT_FLAG_OWN_Z) != (points[start].flags & POINT_FLAG_OWN_Z) ||
+           points[end].seq != points[start].seq + (end - start);
+}
+
+/**
+ * @brief Append a value in 0.01 mm as mm with two decimals
+ *
+ * @param message `String&`: the message
+ * @param value `int32_t`: the value in 0.01 mm
+ */
+void stream_append_fixed(String& message, int32_t value) {
+    char buffer[16];
+    uint32_t magnitude = value < 0 ? -(int64_t)value : value;
+    snprintf(buffer, sizeof(buffer), "%s%u.%02u", value < 0 ? "-" : "", magnitude / 100, magnitude % 100);
+    message += buffer;
+}
+
+uint8_t stream_format_from_name(const char* name) {
+    if (name == NULL) return STREAM_FORMAT_JSON;
+    if (strcmp(name, "binary") == 0) return STREAM_FORMAT_XYZ;
+    if (strcmp(name, "polar") == 0) return STREAM_FORMAT_POLAR;
+    if (strcmp(name, "ring") == 0) return STREAM_FORMAT_RING;
+    if (strcmp(name, "ring_rle") == 0) return STREAM_FORMAT_RING_RLE;
+    return STREAM_FORMAT_JSON;
+}
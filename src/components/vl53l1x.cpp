@@ -0,0 +1,138 @@
+// Path: src/components/vl53l1x.cpp
+#include "components/vl53l1x.h"    // include/components/vl53l1x.h
+
+const char* VL53L1X_TAG = VL53L1X_TAG_NAME;
+
+// Range status of the sensor to the status of the ST ultra lite driver, 255 is an unknown error
+static const uint8_t vl53l1x_status_map[24] = {
+    255, 255, 255, 5, 2, 4, 1, 7, 3, 0, 255, 255, 9, 13, 255, 255, 255, 255, 10, 6, 255, 255, 11, 12
+};
+
+uint32_t vl53l1x_bus_transactions = 0;
+
+bool vl53l1x_read(TwoWire* wire, uint8_t address, uint16_t reg, uint8_t* data, uint8_t length);
+bool vl53l1x_write(TwoWire* wire, uint8_t address, uint16_t reg, uint8_t value);
+
+/**
+ * @brief Read registers in one bus transaction, the index is written and read back after a repeated start
+ *
+ * @param wire `TwoWire*`: the bus
+ * @param address `uint8_t`: the 7 bit address of the sensor
+ * @param reg `uint16_t`: the first register
+ * @param data `uint8_t*`: the registers
+ * @param length `uint8_t`: the number of registers
+ * @return `bool`: `false` if the sensor did not answer
+ */
+bool vl53l1x_read(TwoWire* wire, uint8_t address, uint16_t reg, uint8_t* data, uint8_t length) {
+    vl53l1x_bus_transactions++;
+    wire->beginTransmission(address);
+    wire->write(reg >> 8);
+    wire->write(reg & 0xFF);
+    if (wire->endTransmission(false) != 0) return false;
+    if (wire->requestFrom(address, (size_t)length) != length) return false;
+    for (uint8_t i = 0; i < length; i++) {
+        data[i] = wire->read();
+    }
+    return true;
+}
+
+bool vl53l1x_write(TwoWire* wire, uint8_t address, uint16_t reg, uint8_t value) {
+    vl53l1x_bus_transactions++;
+    wire->beginTransmission(address);
+    wire->write(reg >> 8);
+    wire->write(reg & 0xFF);
+    wire->write(value);
+    return wire->endTransmission() == 0;
+}
+
+/**
+ * @brief Level of GPIO1 that means a measurement is ready, read once instead of with every sample
+ *
+ * @param wire `TwoWire*`: the bus
+ * @param address `uint8_t`: the sensor
+ * @param polarity `uint8_t*`: `1` active high, `0` active low
+ * @return `bool`: `false` if the sensor did not answer
+ */
+bool vl53l1x_read_polarity(TwoWire* wire, uint8_t address, uint8_t* polarity) {
+    uint8_t value;
+    if (!vl53l1x_read(wire, address, VL53L1X_GPIO_HV_MUX__CTRL, &value, 1)) return false;
+    *polarity = !((value >> 4) & 0x01);
+    return true;
+}
+
+/**
+ * @brief A new measurement is ready, one register read
+ *
+ * @param wire `TwoWire*`: the bus
+ * @param address `uint8_t`: the sensor
+ * @param polarity `uint8_t`: see `vl53l1x_read_polarity`
+ */
+bool vl53l1x_data_ready(TwoWire* wire, uint8_t address, uint8_t polarity) {
+    uint8_t value;
+    if (!vl53l1x_read(wire, address, VL53L1X_GPIO__TIO_HV_STATUS, &value, 1)) return false;
+    return (value & 0x01) == polarity;
+}
+
+/**
+ * @brief Status, distance, signal and ambient of the last measurement in one burst read
+ *
+ * @param wire `TwoWire*`: the bus
+ * @param address `uint8_t`: the sensor
+ * @param result `vl53l1x_result_t*`: the measurement
+ * @return `bool`: `false` if the sensor did not answer
+ */
+bool vl53l1x_read_result(TwoWire* wire, uint8_t address, vl53l1x_result_t* result) {
+    uint8_t raw[VL53L1X_RESULT_LENGTH];
+    if (!vl53l1x_read(wire, address, VL53L1X_RESULT__RANGE_STATUS, raw, VL53L1X_RESULT_LENGTH)) return false;
+    vl53l1x_decode_result(raw, result);
+    return true;
+}
+
+/**
+ * @brief Rearm GPIO1 for the next measurement
+ */
+bool vl53l1x_clear_interrupt(TwoWire* wire, uint8_t address) {
+    return vl53l1x_write(wire, address, VL53L1X_SYSTEM__INTERRUPT_CLEAR, 0x01);
+}
+
+/**
+ * @brief Read the next sample and rearm the sensor
+ *
+ * Two bus transactions, one burst of status, distance, signal and ambient and the interrupt clear. Without an interrupt
+ * the ready flag is read first.
+ *
+ * @param wire `TwoWire*`: the bus
+ * @param address `uint8_t`: the sensor
+ * @param polarity `uint8_t`: see `vl53l1x_read_polarity`
+ * @param interrupt `bool`: the interrupt of the sensor fired, the sample is ready
+ * @param result `vl53l1x_result_t*`: the measurement, status `255` if the burst failed
+ * @return `bool`: `false` if no sample is ready
+ */
+bool vl53l1x_read_sample(TwoWire* wire, uint8_t address, uint8_t polarity, bool interrupt, vl53l1x_result_t* result) {
+    if (!interrupt && !vl53l1x_data_ready(wire, address, polarity)) return false;
+    if (!vl53l1x_read_result(wire, address, result)) result->status = 255;
+    vl53l1x_clear_interrupt(wire, address);
+    return true;
+}
+
+/**
+ * @brief Decode the result registers, kept free of bus access so captured reads can be replayed off target
+ *
+ * @param raw `const uint8_t*`: `VL53L1X_RESULT_LENGTH` registers from `VL53L1X_RESULT__RANGE_STATUS`
+ * @param result `vl53l1x_result_t*`: the measurement
+ */
+void vl53l1x_decode_result(const uint8_t* raw, vl53l1x_result_t* result) {
+    uint8_t status = raw[0] & 0x1F;
+    result->status = status < sizeof(vl53l1x_status_map) ? vl53l1x_status_map[status] : 255;
+    result->spads = raw[3];
+    result->ambient_rate = ((uint16_t)raw[7] << 8 | raw[8]) * 8;
+    result->distance = (uint16_t)raw[13] << 8 | raw[14];
+    result->signal_rate = ((uint16_t)raw[15] << 8 | raw[16]) * 8;
+}
+
+/**
+ * @brief Bus transactions of this driver since boot
+ */
+uint32_t vl53l1x_transactions() {
+    return vl53l1x_bus_transactions;
+}
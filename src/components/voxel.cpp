@@ -0,0 +1,160 @@
+// Path: src/components/voxel.cpp
+#include "components/voxel.h"    // include/components/voxel.h
+
+const char* VOXEL_TAG = VOXEL_TAG_NAME;
+
+uint16_t voxel_home(uint32_t z_bin, uint16_t angle_bin);
+int32_t voxel_find(const voxel_t* voxel, uint32_t z_bin, uint16_t angle_bin);
+void voxel_remove(voxel_t* voxel, uint16_t slot);
+bool voxel_lowest_band(const voxel_t* voxel, uint32_t* band);
+
+/**
+ * @brief Start a scan with no voxels, nothing is allocated
+ *
+ * @param voxel `voxel_t*`: the grid
+ */
+void voxel_begin(voxel_t* voxel) {
+    memset(voxel->entries, 0, sizeof(voxel->entries));
+    voxel->count = 0;
+    voxel->band_valid = false;
+}
+
+/**
+ * @brief Add a surface point to the voxel of its angle and Z band
+ *
+ * @param voxel `voxel_t*`: the grid
+ * @param config `const voxel_config_t*`: the voxel size
+ * @param point `const scanner_point_t*`: the point, not a no surface one
+ * @return `bool`: `false` if the point needs a new voxel and the grid is full
+ */
+bool voxel_add(voxel_t* voxel, const voxel_config_t* config, const scanner_point_t* point) {
+    uint32_t z_bin = point->z_steps / config->z_size;
+    uint16_t angle_bin = min((uint32_t)point->x_y_steps * config->angle_bins / config->angle_max, (uint32_t)config->angle_bins - 1);
+    uint16_t angle_start = ((uint32_t)angle_bin * config->angle_max + config->angle_bins - 1) / config->angle_bins;
+
+    int32_t slot = voxel_find(voxel, z_bin, angle_bin);
+    voxel_entry_t* entry;
+    if (slot >= 0) {
+        entry = &voxel->entries[slot];
+        if (entry->count == UINT16_MAX) return true;
+    } else {
+        // One slot stays free so every probe ends
+        if (voxel->count >= VOXEL_CAPACITY - 1) return false;
+        uint16_t i = voxel_home(z_bin, angle_bin);
+        while (voxel->entries[i].count > 0) i = (i + 1) & (VOXEL_CAPACITY - 1);
+        entry = &voxel->entries[i];
+        entry->z_bin = z_bin;
+        entry->angle_bin = angle_bin;
+        entry->time_ms = point->time_ms;
+        entry->angle_sum = 0;
+        entry->r_sum = 0;
+        entry->flags = 0;
+        voxel->count++;
+    }
+    entry->count++;
+    entry->angle_sum += point->x_y_steps - angle_start;
+    entry->r_sum += point->r;
+    entry->flags |= point->flags;
+    return true;
+}
+
+/**
+ * @brief Hand out the mean point of the next voxel whose Z band lies below `z_floor`, band by band and in turntable order
+ *
+ * The point sits at the middle of its band and carries only the filter flag of its points.
+ *
+ * @param voxel `voxel_t*`: the grid
+ * @param config `const voxel_config_t*`: the voxel size
+ * @param z_floor `uint32_t`: no point below this Z axis position is still to come, `UINT32_MAX` hands out all voxels
+ * @param point `scanner_point_t*`: the mean point, without `seq`
+ * @param band_start `bool*`: the point is the first of its band
+ * @return `bool`: `false` if no voxel is complete
+ */
+bool voxel_pop(voxel_t* voxel, const voxel_config_t* config, uint32_t z_floor, scanner_point_t* point, bool* band_start) {
+    while (voxel->count > 0) {
+        if (!voxel->band_valid) {
+            if (!voxel_lowest_band(voxel, &voxel->band)) return false;
+            voxel->band_valid = true;
+            voxel->band_start = true;
+            voxel->angle_bin = 0;
+        }
+        if (z_floor != UINT32_MAX && ((uint64_t)voxel->band + 1) * config->z_size > z_floor) {
+            voxel->band_valid = false;
+            return false;
+        }
+
+        for (; voxel->angle_bin < config->angle_bins; voxel->angle_bin++) {
+            int32_t slot = voxel_find(voxel, voxel->band, voxel->angle_bin);
+            if (slot < 0) continue;
+
+            const voxel_entry_t* entry = &voxel->entries[slot];
+            uint16_t angle_start = ((uint32_t)entry->angle_bin * config->angle_max + config->angle_bins - 1) / config->angle_bins;
+            point->time_ms = entry->time_ms;
+            point->z_steps = entry->z_bin * config->z_size + config->z_size / 2;
+            point->x_y_steps = angle_start + entry->angle_sum / entry->count;
+            point->r = entry->r_sum / entry->count;
+            point->flags = entry->flags & POINT_FLAG_FILTERED;
+            *band_start = voxel->band_start;
+            voxel->band_start = false;
+            voxel_remove(voxel, slot);
+            voxel->angle_bin++;
+            return true;
+        }
+        voxel->band_valid = false;
+    }
+    voxel->band_valid = false;
+    return false;
+}
+
+uint16_t voxel_count(const voxel_t* voxel) {
+    return voxel->count;
+}
+
+uint16_t voxel_home(uint32_t z_bin, uint16_t angle_bin) {
+    return ((z_bin * 2654435761u) ^ (angle_bin * 40503u)) & (VOXEL_CAPACITY - 1);
+}
+
+/**
+ * @brief Slot of a voxel, linear probing from its home slot
+ *
+ * @return `int32_t`: the slot, `-1` if the voxel has no points
+ */
+int32_t voxel_find(const voxel_t* voxel, uint32_t z_bin, uint16_t angle_bin) {
+    uint16_t i = voxel_home(z_bin, angle_bin);
+    while (voxel->entries[i].count > 0) {
+        if (voxel->entries[i].z_bin == z_bin && voxel->entries[i].angle_bin == angle_bin) return i;
+        i = (i + 1) & (VOXEL_CAPACITY - 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Free a slot and shift the probe chain after it back, so no tombstones are left
+ */
+void voxel_remove(voxel_t* voxel, uint16_t slot) {
+    uint16_t i = slot;
+    uint16_t j = slot;
+    voxel->entries[i].count = 0;
+    voxel->count--;
+    for (;;) {
+        j = (j + 1) & (VOXEL_CAPACITY - 1);
+        if (voxel->entries[j].count == 0) return;
+        uint16_t home = voxel_home(voxel->entries[j].z_bin, voxel->entries[j].angle_bin);
+        // An entry whose home lies cyclically in (i, j] is still reachable
+        bool reachable = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (reachable) continue;
+        voxel->entries[i] = voxel->entries[j];
+        voxel->entries[j].count = 0;
+        i = j;
+    }
+}
+
+bool voxel_lowest_band(const voxel_t* voxel, uint32_t* band) {
+    bool found = false;
+    for (uint16_t i = 0; i < VOXEL_CAPACITY; i++) {
+        if (voxel->entries[i].count == 0) continue;
+        if (!found || voxel->entries[i].z_bin < *band) *band = voxel->entries[i].z_bin;
+        found = true;
+    }
+    return found;
+}
@@ -7,12 +7,13 @@ void setup() {
     init_nvs();
     init_network();
     init_server();
+    init_stream();
+    init_recorder();
 
     module_init();
     set_command(SCANNER_COMMAND_HOME);
 }
 
 void loop() {
-    scanner_loop();
     ota_loop();
 }
@@ -0,0 +1,114 @@
+// Path: test/stubs/Arduino.h
+// Host stand-in for the parts of the ESP32 Arduino core the portable components use
+#ifndef __3D_SCANNER_TEST_ARDUINO_H__
+#define __3D_SCANNER_TEST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "WString.h"
+
+#define IRAM_ATTR
+
+#define PI 3.1415926535897932384626433832795
+
+#define LOW    0x0
+#define HIGH   0x1
+#define INPUT  0x01
+#define OUTPUT 0x03
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline void digitalWrite(uint8_t pin, uint8_t value) {}
+inline int digitalRead(uint8_t pin) { return LOW; }
+
+inline unsigned long micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) {}
+
+// FreeRTOS, the tests run on one thread
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+inline void vTaskDelay(TickType_t ticks) {}
+
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+#define portENTER_CRITICAL(mux)     ((void)(mux))
+#define portEXIT_CRITICAL(mux)      ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)  ((void)(mux))
+
+// A queue is a FIFO of copies, nothing blocks
+typedef struct {
+    size_t length;
+    size_t item_size;
+    std::deque<std::vector<uint8_t>> items;
+} queue_t;
+typedef queue_t* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(size_t length, size_t item_size) {
+    return new queue_t{ length, item_size, {} };
+}
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    if (queue->items.size() >= queue->length) return pdFALSE;
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+    return pdTRUE;
+}
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    if (queue->items.empty()) return pdFALSE;
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+inline size_t uxQueueMessagesWaiting(QueueHandle_t queue) { return queue->items.size(); }
+
+// Tasks are created but never run, a test calls their steps itself
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack_size, void* parameter,
+                                          uint32_t priority, TaskHandle_t* handle, BaseType_t core) {
+    static int created;
+    if (handle != NULL) *handle = &created;
+    return pdPASS;
+}
+inline void xTaskNotifyGive(TaskHandle_t task) {}
+
+// Binary semaphores, a take that would block fails at once
+typedef int* SemaphoreHandle_t;
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new int(1); }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new int(0); }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    if (*semaphore == 0) return pdFALSE;
+    *semaphore = 0;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    *semaphore = 1;
+    return pdTRUE;
+}
+
+#endif // __3D_SCANNER_TEST_ARDUINO_H__
@@ -0,0 +1,121 @@
+// Path: test/stubs/FS.h
+// Host stand-in for the Arduino fs::FS, backed by a directory of the host
+#ifndef __3D_SCANNER_TEST_FS_H__
+#define __3D_SCANNER_TEST_FS_H__
+
+#include <Arduino.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+public:
+    File() {}
+
+    static File open_file(const std::string& host_path, const std::string& name, const char* mode) {
+        File file;
+        FILE* handle = fopen(host_path.c_str(), mode);
+        if (handle == NULL) return file;
+        file.handle = std::make_shared<host_file_t>(handle);
+        file.file_name = name;
+        return file;
+    }
+
+    static File open_dir(const std::string& host_path, const std::string& name) {
+        File file;
+        file.dir = std::make_shared<std::filesystem::directory_iterator>(host_path);
+        file.file_name = name;
+        file.host_path = host_path;
+        return file;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        if (!handle) return 0;
+        turn(true);
+        return fwrite(buffer, 1, size, handle->file);
+    }
+    size_t read(uint8_t* buffer, size_t size) {
+        if (!handle) return 0;
+        turn(false);
+        return fread(buffer, 1, size, handle->file);
+    }
+    bool seek(uint32_t position, SeekMode mode = SeekSet) { return handle && fseek(handle->file, position, mode) == 0; }
+    size_t position() const { return handle ? ftell(handle->file) : 0; }
+    size_t size() const {
+        if (!handle) return 0;
+        long position = ftell(handle->file);
+        fseek(handle->file, 0, SEEK_END);
+        long end = ftell(handle->file);
+        fseek(handle->file, position, SEEK_SET);
+        return end;
+    }
+    void flush() { if (handle) fflush(handle->file); }
+    void close() { handle.reset(); dir.reset(); }
+    const char* name() const { return file_name.c_str(); }
+    bool isDirectory() const { return dir != nullptr; }
+
+    File openNextFile() {
+        if (!dir || *dir == std::filesystem::directory_iterator()) return File();
+        std::filesystem::path path = (*dir)->path();
+        ++*dir;
+        std::string name = file_name + "/" + path.filename().string();
+        if (std::filesystem::is_directory(path)) return open_dir(path.string(), name);
+        return open_file(path.string(), name, "r");
+    }
+
+    operator bool() const { return handle != nullptr || dir != nullptr; }
+
+private:
+    // stdio needs a seek between reads and writes of an "r+" file, the card does not
+    void turn(bool write) {
+        if (handle->writing != write) fseek(handle->file, 0, SEEK_CUR);
+        handle->writing = write;
+    }
+
+    struct host_file_t {
+        FILE* file;
+        bool writing = false;
+        host_file_t(FILE* file) : file(file) {}
+        ~host_file_t() { fclose(file); }
+    };
+
+    std::shared_ptr<host_file_t> handle;
+    std::shared_ptr<std::filesystem::directory_iterator> dir;
+    std::string file_name;
+    std::string host_path;
+};
+
+class FS {
+public:
+    FS(const std::string& root = "") : root(root) {}
+
+    File open(const char* path, const char* mode = FILE_READ, bool create = false) {
+        std::string host_path = root + path;
+        if (std::filesystem::is_directory(host_path)) return File::open_dir(host_path, path);
+        // The SD library of the ESP32 opens "r+" without creating the file too
+        return File::open_file(host_path, path, mode);
+    }
+    bool exists(const char* path) { return std::filesystem::exists(root + path); }
+    bool remove(const char* path) { return ::remove((root + path).c_str()) == 0; }
+    bool rename(const char* from, const char* to) { return ::rename((root + from).c_str(), (root + to).c_str()) == 0; }
+    bool mkdir(const char* path) { return std::filesystem::create_directories(root + path); }
+
+protected:
+    std::string root;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // __3D_SCANNER_TEST_FS_H__
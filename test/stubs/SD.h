@@ -0,0 +1,25 @@
+// Path: test/stubs/SD.h
+// Host stand-in for the SD card, a fresh temporary directory every begin()
+#ifndef __3D_SCANNER_TEST_SD_H__
+#define __3D_SCANNER_TEST_SD_H__
+
+#include <FS.h>
+
+class SDFS : public fs::FS {
+public:
+    bool begin(uint8_t ss_pin = 5) {
+        char path[] = "/tmp/3d_scanner_sd_XXXXXX";
+        if (mkdtemp(path) == NULL) return false;
+        root = path;
+        return true;
+    }
+
+    void end() {
+        if (!root.empty()) std::filesystem::remove_all(root);
+        root.clear();
+    }
+};
+
+inline SDFS SD;
+
+#endif // __3D_SCANNER_TEST_SD_H__
@@ -0,0 +1,15 @@
+// Path: test/stubs/SPI.h
+#ifndef __3D_SCANNER_TEST_SPI_H__
+#define __3D_SCANNER_TEST_SPI_H__
+
+#include <Arduino.h>
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+};
+
+inline SPIClass SPI;
+
+#endif // __3D_SCANNER_TEST_SPI_H__
@@ -0,0 +1,29 @@
+// Path: test/stubs/WString.h
+// Host stand-in for the Arduino String, only what the components use
+#ifndef __3D_SCANNER_TEST_WSTRING_H__
+#define __3D_SCANNER_TEST_WSTRING_H__
+
+#include <string>
+
+class String {
+public:
+    String() {}
+    String(const char* value) : value(value != NULL ? value : "") {}
+    String(const std::string& value) : value(value) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.length(); }
+
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(const char* other) { value += other; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend String operator+(const String& a, const char* b) { return String(a.value + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.value); }
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* other) const { return value == other; }
+
+private:
+    std::string value;
+};
+
+#endif // __3D_SCANNER_TEST_WSTRING_H__
@@ -0,0 +1,53 @@
+// Path: test/stubs/Wire.h
+// Host stand-in for the I2C bus, a bank of 16 bit indexed registers that counts what the driver asks of it
+#ifndef __3D_SCANNER_TEST_WIRE_H__
+#define __3D_SCANNER_TEST_WIRE_H__
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    uint8_t registers[0x10000];
+    uint32_t transmissions = 0;  // `beginTransmission` calls, one per bus transaction
+    uint32_t requests = 0;       // reads after a repeated start
+    bool nack = false;           // the sensor does not answer
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    bool setClock(uint32_t frequency) { return true; }
+
+    void beginTransmission(uint8_t address) {
+        transmissions++;
+        length = 0;
+    }
+
+    size_t write(uint8_t value) {
+        if (length < sizeof(buffer)) buffer[length++] = value;
+        return 1;
+    }
+
+    uint8_t endTransmission(bool stop = true) {
+        if (nack) return 2;
+        if (length >= 2) index = (uint16_t)(buffer[0] << 8 | buffer[1]);
+        for (size_t i = 2; i < length; i++) registers[(uint16_t)(index + i - 2)] = buffer[i];
+        return 0;
+    }
+
+    size_t requestFrom(uint8_t address, size_t size, bool stop = true) {
+        requests++;
+        if (nack) return 0;
+        cursor = index;
+        return size;
+    }
+
+    int read() { return registers[cursor++]; }
+
+private:
+    uint8_t buffer[32];
+    size_t length = 0;
+    uint16_t index = 0;
+    uint16_t cursor = 0;
+};
+
+inline TwoWire Wire;
+
+#endif // __3D_SCANNER_TEST_WIRE_H__
@@ -0,0 +1,51 @@
+// Path: test/stubs/components/module.h
+// Host stand-in for include/components/module.h, found first on the include path of the tests.
+// The recorder and the catalogue only need the SD pins, the kinematics and the module settings.
+#ifndef __3D_SCANNER_MODULE_H__
+#define __3D_SCANNER_MODULE_H__
+
+#include <Arduino.h>
+
+#include "esp_log.h"
+
+#include "components/points.h"
+#include "components/kinematics.h"
+#include "components/recorder.h"
+#include "components/catalog.h"
+
+#define SPI_MOSI 23
+#define SPI_MISO 19
+#define SPI_SCK  18
+#define SPI_CS    5
+
+#define MOTOR1_DEFAULT_STEPS_PER_REV 200
+#define MOTOR1_DEFAULT_MICRO_STEP  32
+#define Z_AXIS_STEP_NM 1250
+
+typedef kinematics<MOTOR1_DEFAULT_STEPS_PER_REV, MOTOR1_DEFAULT_MICRO_STEP, Z_AXIS_STEP_NM> scanner_kinematics;
+
+inline void get_x_y(uint32_t x_y_steps, uint16_t r, int32_t* x, int32_t* y) {
+    scanner_kinematics::polar_to_xy(x_y_steps, r, x, y);
+}
+
+inline int32_t get_z(uint32_t z_steps) {
+    return scanner_kinematics::z(z_steps);
+}
+
+// The NVS defaults
+inline void get_module(uint16_t* z_axis_max, uint16_t* z_axis_start_step, uint16_t* z_axis_delay_time, uint16_t* z_axis_one_time_step,
+                       uint16_t* x_y_axis_max, uint16_t* x_y_axis_check_times, uint16_t* x_y_axis_step_delay_time, uint16_t* x_y_axis_one_time_step,
+                       uint16_t* vl53l1x_center, uint16_t* vl53l1x_timeing_budget) {
+    *z_axis_max = 47000;
+    *z_axis_start_step = 0;
+    *z_axis_delay_time = 100;
+    *z_axis_one_time_step = 400;
+    *x_y_axis_max = 6400;
+    *x_y_axis_check_times = 1;
+    *x_y_axis_step_delay_time = 50;
+    *x_y_axis_one_time_step = 8;
+    *vl53l1x_center = 70;
+    *vl53l1x_timeing_budget = 200;
+}
+
+#endif // __3D_SCANNER_MODULE_H__
@@ -0,0 +1,40 @@
+// Path: test/stubs/driver/timer.h
+// Host stand-in for the general purpose timers, the tests call `stepper_next_edge` in place of the ISR
+#ifndef __3D_SCANNER_TEST_DRIVER_TIMER_H__
+#define __3D_SCANNER_TEST_DRIVER_TIMER_H__
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+inline const char* esp_err_to_name(esp_err_t err) { return err == ESP_OK ? "ESP_OK" : "ESP_FAIL"; }
+
+typedef enum { TIMER_GROUP_0, TIMER_GROUP_1 } timer_group_t;
+typedef enum { TIMER_0, TIMER_1 } timer_idx_t;
+typedef enum { TIMER_ALARM_DIS, TIMER_ALARM_EN } timer_alarm_t;
+typedef enum { TIMER_PAUSE, TIMER_START } timer_start_t;
+typedef enum { TIMER_INTR_LEVEL } timer_intr_mode_t;
+typedef enum { TIMER_COUNT_DOWN, TIMER_COUNT_UP } timer_count_dir_t;
+typedef enum { TIMER_AUTORELOAD_DIS, TIMER_AUTORELOAD_EN } timer_autoreload_t;
+typedef bool (*timer_isr_t)(void* arg);
+
+typedef struct {
+    timer_alarm_t alarm_en;
+    timer_start_t counter_en;
+    timer_intr_mode_t intr_type;
+    timer_count_dir_t counter_dir;
+    timer_autoreload_t auto_reload;
+    uint32_t divider;
+} timer_config_t;
+
+inline esp_err_t timer_init(timer_group_t group, timer_idx_t idx, const timer_config_t* config) { return ESP_OK; }
+inline esp_err_t timer_set_counter_value(timer_group_t group, timer_idx_t idx, uint64_t value) { return ESP_OK; }
+inline esp_err_t timer_set_alarm_value(timer_group_t group, timer_idx_t idx, uint64_t value) { return ESP_OK; }
+inline esp_err_t timer_enable_intr(timer_group_t group, timer_idx_t idx) { return ESP_OK; }
+inline esp_err_t timer_isr_callback_add(timer_group_t group, timer_idx_t idx, timer_isr_t isr, void* arg, int flags) { return ESP_OK; }
+inline esp_err_t timer_start(timer_group_t group, timer_idx_t idx) { return ESP_OK; }
+inline esp_err_t timer_pause(timer_group_t group, timer_idx_t idx) { return ESP_OK; }
+inline void timer_group_set_alarm_value_in_isr(timer_group_t group, timer_idx_t idx, uint64_t value) {}
+inline void timer_group_set_counter_enable_in_isr(timer_group_t group, timer_idx_t idx, timer_start_t enable) {}
+
+#endif // __3D_SCANNER_TEST_DRIVER_TIMER_H__
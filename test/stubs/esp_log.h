@@ -0,0 +1,12 @@
+// Path: test/stubs/esp_log.h
+// Host stand-in, the logs of the components are dropped
+#ifndef __3D_SCANNER_TEST_ESP_LOG_H__
+#define __3D_SCANNER_TEST_ESP_LOG_H__
+
+#define ESP_LOGE(tag, format, ...) ((void)(tag))
+#define ESP_LOGW(tag, format, ...) ((void)(tag))
+#define ESP_LOGI(tag, format, ...) ((void)(tag))
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
+
+#endif // __3D_SCANNER_TEST_ESP_LOG_H__
@@ -0,0 +1,146 @@
+// Path: test/test_codec/test_main.cpp
+#include <unity.h>
+
+#include <random>
+#include <vector>
+
+#include "components/codec.h"
+
+// The point room of a ring frame in src/components/stream.cpp
+#define BODY_POINTS 128
+#define BODY_SIZE (CODEC_RING_HEADER_BYTES + BODY_POINTS * CODEC_RING_POINT_BYTES)
+
+#define RINGS 20000
+#define RING_POINTS 400
+
+typedef struct {
+    uint16_t angle;
+    uint16_t r;
+    int16_t dz;
+} point_t;
+
+static std::mt19937 rng(22);
+
+void setUp() {}
+
+void tearDown() {}
+
+static uint32_t uniform(uint32_t low, uint32_t high) {
+    return std::uniform_int_distribution<uint32_t>(low, high)(rng);
+}
+
+/**
+ * @brief A ring of a scan: a fixed step with the odd gap, radii that hold, drift or jump, no surface stretches
+ */
+static std::vector<point_t> random_ring() {
+    std::vector<point_t> ring(uniform(1, RING_POINTS));
+    uint16_t angle = uniform(0, 6399);
+    uint16_t step = uniform(1, 64);
+    uint16_t r = uniform(0, UINT16_MAX);
+    for (point_t& point : ring) {
+        point.angle = angle;
+        angle += uniform(0, 49) == 0 ? step * uniform(2, 5) : step;
+        switch (uniform(0, 5)) {
+            case 0: r = uniform(0, UINT16_MAX); break;
+            case 1: r = 0; break;
+            case 2: r += (int16_t)uniform(0, 200) - 100; break;
+            default: break;
+        }
+        point.r = r;
+        point.dz = uniform(0, 3) == 0 ? (int16_t)uniform(0, UINT16_MAX) : (int16_t)uniform(0, 40) - 20;
+    }
+    return ring;
+}
+
+/**
+ * @brief Encode a ring the way `stream_send_ring` does, a new body where a point does not fit, decode every body back
+ *
+ * @return `size_t`: the body bytes
+ */
+static size_t round_trip(const std::vector<point_t>& ring, bool rle, bool dz) {
+    uint8_t body[BODY_SIZE];
+    codec_ring_encoder_t encoder;
+    // Small changes and runs of radii fit more than `BODY_POINTS` in a body, up to the whole ring
+    uint16_t angles[RING_POINTS + 1], r[RING_POINTS + 1];
+    int16_t dz_values[RING_POINTS + 1];
+    size_t bytes = 0;
+
+    size_t start = 0;
+    while (start < ring.size()) {
+        codec_ring_begin(&encoder, body, sizeof(body), rle, dz);
+        size_t end = start;
+        while (end < ring.size() && codec_ring_add(&encoder, ring[end].angle, ring[end].r, ring[end].dz)) end++;
+        TEST_ASSERT_GREATER_THAN(start, end);
+        size_t length = codec_ring_end(&encoder);
+        TEST_ASSERT_LESS_OR_EQUAL(sizeof(body), length);
+        bytes += length;
+
+        uint16_t count = end - start;
+        TEST_ASSERT_TRUE(codec_ring_decode(body, length, count, rle, dz, angles, r, dz ? dz_values : NULL));
+        for (size_t i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL_UINT16(ring[start + i].angle, angles[i]);
+            TEST_ASSERT_EQUAL_UINT16(ring[start + i].r, r[i]);
+            if (dz) TEST_ASSERT_EQUAL_INT16(ring[start + i].dz, dz_values[i]);
+        }
+        // One point more or less than the body holds does not decode
+        TEST_ASSERT_FALSE(codec_ring_decode(body, length, count + 1, rle, dz, angles, r, dz ? dz_values : NULL));
+        if (count > 1 && !rle) TEST_ASSERT_FALSE(codec_ring_decode(body, length, count - 1, rle, dz, angles, r, dz ? dz_values : NULL));
+        start = end;
+    }
+    return bytes;
+}
+
+void test_random_rings() {
+    size_t points = 0, bytes[3] = {0, 0, 0};
+    for (uint32_t i = 0; i < RINGS; i++) {
+        std::vector<point_t> ring = random_ring();
+        points += ring.size();
+        bytes[0] += round_trip(ring, false, false);
+        bytes[1] += round_trip(ring, true, false);
+        bytes[2] += round_trip(ring, false, true);
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u rings, %u points, bytes per point: ring %.2f, rle %.2f, dz %.2f",
+             RINGS, (unsigned)points, (double)bytes[0] / points, (double)bytes[1] / points, (double)bytes[2] / points);
+    TEST_MESSAGE(message);
+}
+
+void test_cut_short() {
+    std::vector<point_t> ring = {{100, 5000, 3}, {108, 5000, -2}, {116, 5000, 0}, {124, 40000, 1}};
+    uint8_t body[BODY_SIZE];
+    codec_ring_encoder_t encoder;
+    codec_ring_begin(&encoder, body, sizeof(body), true, false);
+    for (const point_t& point : ring) TEST_ASSERT_TRUE(codec_ring_add(&encoder, point.angle, point.r, point.dz));
+    size_t length = codec_ring_end(&encoder);
+
+    uint16_t angles[4], r[4];
+    TEST_ASSERT_TRUE(codec_ring_decode(body, length, 4, true, false, angles, r, NULL));
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_FALSE(codec_ring_decode(body, cut, 4, true, false, angles, r, NULL));
+    }
+}
+
+void test_varint_zigzag() {
+    const int32_t values[] = {0, 1, -1, 63, -64, 64, INT16_MAX, INT16_MIN, UINT16_MAX, -UINT16_MAX, INT32_MAX, INT32_MIN};
+    for (int32_t value : values) {
+        TEST_ASSERT_EQUAL_INT32(value, codec_unzigzag(codec_zigzag(value)));
+
+        uint8_t buffer[5];
+        uint32_t decoded;
+        size_t length = codec_put_varint(buffer, codec_zigzag(value));
+        TEST_ASSERT_EQUAL_size_t(length, codec_get_varint(buffer, length, &decoded));
+        TEST_ASSERT_EQUAL_UINT32(codec_zigzag(value), decoded);
+        TEST_ASSERT_EQUAL_size_t(0, codec_get_varint(buffer, length - 1, &decoded));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, codec_zigzag(-1));
+    TEST_ASSERT_EQUAL_UINT32(2, codec_zigzag(1));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_random_rings);
+    RUN_TEST(test_cut_short);
+    RUN_TEST(test_varint_zigzag);
+    return UNITY_END();
+}
@@ -0,0 +1,202 @@
+// Path: test/test_estimator/test_main.cpp
+#include <unity.h>
+
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "components/estimator.h"
+
+// The distance window of include/components/module.h around a 100 mm center
+#define WINDOW_MIN (100 - 70)
+#define WINDOW_MAX (100 + 70)
+
+static estimator_t estimator;
+
+void setUp() {}
+
+void tearDown() {}
+
+static uint16_t estimate(uint8_t type, uint16_t min, uint16_t max, const std::vector<uint16_t>& samples) {
+    estimator_begin(&estimator, type, min, max);
+    for (uint16_t sample : samples) TEST_ASSERT_TRUE(estimator_add(&estimator, sample));
+    return estimator_result(&estimator);
+}
+
+/**
+ * @brief The mode before the estimator, a hash map of counts over a vector of samples
+ */
+static int16_t find_mode_map(const std::vector<int16_t>& numbers) {
+    std::unordered_map<int16_t, int16_t> frequencyMap;
+
+    for (int16_t num : numbers) {
+        frequencyMap[num]++;
+    }
+
+    int16_t mode = numbers[0];
+    int16_t maxCount = 0;
+
+    for (const auto& pair : frequencyMap) {
+        if (pair.second > maxCount) {
+            maxCount = pair.second;
+            mode = pair.first;
+        }
+    }
+
+    return mode;
+}
+
+void test_empty() {
+    estimator_begin(&estimator, ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX);
+    TEST_ASSERT_EQUAL(0, estimator_result(&estimator));
+    TEST_ASSERT_EQUAL(0, estimator_variance(&estimator));
+    TEST_ASSERT_FALSE(estimator_confident(&estimator, 100));
+}
+
+void test_window_and_capacity() {
+    estimator_begin(&estimator, ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX);
+    TEST_ASSERT_FALSE(estimator_add(&estimator, WINDOW_MIN - 1));
+    TEST_ASSERT_FALSE(estimator_add(&estimator, WINDOW_MAX + 1));
+    TEST_ASSERT_TRUE(estimator_add(&estimator, WINDOW_MIN));
+    TEST_ASSERT_TRUE(estimator_add(&estimator, WINDOW_MAX));
+    for (uint16_t i = 2; i < ESTIMATOR_MAX_SAMPLES; i++) TEST_ASSERT_TRUE(estimator_add(&estimator, 100));
+    TEST_ASSERT_FALSE(estimator_add(&estimator, 100));
+    TEST_ASSERT_EQUAL(ESTIMATOR_MAX_SAMPLES, estimator_count(&estimator));
+}
+
+void test_mode() {
+    TEST_ASSERT_EQUAL(101, estimate(ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX, { 100, 101, 102, 101, 30, 170 }));
+    TEST_ASSERT_EQUAL(WINDOW_MIN, estimate(ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX, { WINDOW_MIN }));
+    TEST_ASSERT_EQUAL(WINDOW_MAX, estimate(ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX, { WINDOW_MAX, WINDOW_MAX, 100 }));
+}
+
+void test_mode_tie() {
+    // The lowest of the fullest bins, whatever order the samples came in
+    TEST_ASSERT_EQUAL(100, estimate(ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX, { 105, 100, 105, 100 }));
+    TEST_ASSERT_EQUAL(100, estimate(ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX, { 100, 105, 100, 105 }));
+    TEST_ASSERT_EQUAL(31, estimate(ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX, { 170, 31, 90 }));
+}
+
+void test_mode_wide_bins() {
+    // 1024 mm over 256 bins, 4 mm per bin
+    estimator_begin(&estimator, ESTIMATOR_MODE, 0, 1023);
+    TEST_ASSERT_EQUAL(4, estimator.bin_width);
+
+    // Bin 100 holds three samples, the result is their rounded mean and not the bin start
+    TEST_ASSERT_EQUAL(401, estimate(ESTIMATOR_MODE, 0, 1023, { 410, 400, 401, 411, 403 }));
+    TEST_ASSERT_EQUAL(402, estimate(ESTIMATOR_MODE, 0, 1023, { 403, 403, 400, 999 }));
+    // Bins 100 and 101 tie, the lower one wins and its mean 400.5 rounds up
+    TEST_ASSERT_EQUAL(401, estimate(ESTIMATOR_MODE, 0, 1023, { 404, 405, 400, 401 }));
+    // A window that does not split evenly still fits the last sample in the last bin
+    TEST_ASSERT_EQUAL(65535, estimate(ESTIMATOR_MODE, 0, 65535, { 65535, 65535, 0 }));
+}
+
+void test_median() {
+    TEST_ASSERT_EQUAL(100, estimate(ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX, { 100 }));
+    TEST_ASSERT_EQUAL(90, estimate(ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX, { 170, 31, 90 }));
+    // An even count takes the rounded mean of the middle pair
+    TEST_ASSERT_EQUAL(95, estimate(ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX, { 100, 150, 40, 90 }));
+    TEST_ASSERT_EQUAL(101, estimate(ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX, { 101, 100 }));
+    TEST_ASSERT_EQUAL(100, estimate(ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX, { 100, 100, 100, 100 }));
+}
+
+void test_trimmed_mean() {
+    // 25 % of 8 is 2 from each end
+    TEST_ASSERT_EQUAL(102, estimate(ESTIMATOR_TRIMMED_MEAN, 0, 1000, { 900, 1, 103, 100, 500, 2, 102, 101 }));
+    // Under four samples nothing is trimmed
+    TEST_ASSERT_EQUAL(2, estimate(ESTIMATOR_TRIMMED_MEAN, 0, 1000, { 1, 2, 3 }));
+    TEST_ASSERT_EQUAL(4, estimate(ESTIMATOR_TRIMMED_MEAN, 0, 1000, { 1, 6 }));
+    // 5 samples trim 1 from each end
+    TEST_ASSERT_EQUAL(20, estimate(ESTIMATOR_TRIMMED_MEAN, 0, 1000, { 0, 10, 20, 30, 1000 }));
+}
+
+void test_variance() {
+    estimate(ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX, { 100 });
+    TEST_ASSERT_EQUAL(0, estimator_variance(&estimator));
+    TEST_ASSERT_FALSE(estimator_confident(&estimator, 100));
+
+    estimate(ESTIMATOR_MEDIAN, WINDOW_MIN, WINDOW_MAX, { 100, 102, 104, 106 });
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 20.0f / 3, estimator_variance(&estimator));
+    // 2 standard errors of the mean are 2 * sqrt(20 / 3 / 4) = 2.58 mm
+    TEST_ASSERT_TRUE(estimator_confident(&estimator, 2.6f));
+    TEST_ASSERT_FALSE(estimator_confident(&estimator, 2.5f));
+}
+
+void test_from_name() {
+    TEST_ASSERT_EQUAL(ESTIMATOR_MEDIAN, estimator_from_name("median"));
+    TEST_ASSERT_EQUAL(ESTIMATOR_TRIMMED_MEAN, estimator_from_name("mean"));
+    TEST_ASSERT_EQUAL(ESTIMATOR_MODE, estimator_from_name("mode"));
+    TEST_ASSERT_EQUAL(ESTIMATOR_MODE, estimator_from_name(NULL));
+}
+
+/**
+ * @brief Mode of noisy points against the hash map, with the samples of each point gathered the same way
+ */
+void test_benchmark() {
+    const uint32_t points = 100000;
+    const uint16_t samples = 16;
+    char message[128];
+
+    std::mt19937 random(1);
+    std::normal_distribution<float> noise(100, 2);
+    std::vector<uint16_t> values(points * samples);
+    for (uint16_t& value : values) value = (uint16_t)lroundf(noise(random));
+
+    std::vector<int16_t> map_modes(points);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < points; i++) {
+        std::vector<int16_t> numbers;
+        for (uint16_t j = 0; j < samples; j++) numbers.push_back(values[i * samples + j]);
+        map_modes[i] = find_mode_map(numbers);
+    }
+    double map_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / points;
+
+    std::vector<uint16_t> modes(points);
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < points; i++) {
+        estimator_begin(&estimator, ESTIMATOR_MODE, WINDOW_MIN, WINDOW_MAX);
+        for (uint16_t j = 0; j < samples; j++) estimator_add(&estimator, values[i * samples + j]);
+        modes[i] = estimator_result(&estimator);
+    }
+    double histogram_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / points;
+
+    snprintf(message, sizeof(message), "%u samples per point: hash map %.0f ns, histogram %.0f ns per point on the host",
+             samples, map_ns, histogram_ns);
+    TEST_MESSAGE(message);
+
+    // Both agree wherever the fullest count is unique, the hash map breaks ties in bucket order
+    uint32_t compared = 0;
+    for (uint32_t i = 0; i < points; i++) {
+        uint8_t counts[WINDOW_MAX + 1] = {};
+        for (uint16_t j = 0; j < samples; j++) counts[values[i * samples + j]]++;
+        uint8_t best = 0, ties = 0;
+        for (uint8_t count : counts) {
+            if (count > best) {
+                best = count;
+                ties = 1;
+            } else if (count == best) {
+                ties++;
+            }
+        }
+        if (ties > 1) continue;
+        TEST_ASSERT_EQUAL(map_modes[i], modes[i]);
+        compared++;
+    }
+    TEST_ASSERT_GREATER_THAN(points / 4, compared);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty);
+    RUN_TEST(test_window_and_capacity);
+    RUN_TEST(test_mode);
+    RUN_TEST(test_mode_tie);
+    RUN_TEST(test_mode_wide_bins);
+    RUN_TEST(test_median);
+    RUN_TEST(test_trimmed_mean);
+    RUN_TEST(test_variance);
+    RUN_TEST(test_from_name);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
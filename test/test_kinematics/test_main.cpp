@@ -0,0 +1,128 @@
+// Path: test/test_kinematics/test_main.cpp
+#include <unity.h>
+
+#include <chrono>
+#include <vector>
+
+#include "components/kinematics.h"
+
+// The turntable and Z axis of include/components/module.h
+#define MOTOR1_DEFAULT_STEP_DEGREE 1.8
+#define MOTOR1_DEFAULT_MICRO_STEP_DEGREE ((MOTOR1_DEFAULT_STEP_DEGREE) / 32)
+typedef kinematics<200, 32, 1250> scanner_kinematics;
+
+// 0.015 mm in 0.01 mm
+#define MAX_ERROR 1.5
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * @brief The conversion before the sine table, in double precision
+ */
+static void get_x_y_double(double angle, double r, double* x, double* y) {
+    *x = r * cos(angle * PI / 180);
+    *y = r * sin(angle * PI / 180);
+}
+
+void test_table_quadrants() {
+    int32_t sin, cos;
+    const uint32_t quarter = scanner_kinematics::quarter;
+    scanner_kinematics::sin_cos(0, &sin, &cos);
+    TEST_ASSERT_EQUAL(0, sin);
+    TEST_ASSERT_EQUAL(KINEMATICS_SINE_ONE, cos);
+    scanner_kinematics::sin_cos(quarter, &sin, &cos);
+    TEST_ASSERT_EQUAL(KINEMATICS_SINE_ONE, sin);
+    TEST_ASSERT_EQUAL(0, cos);
+    scanner_kinematics::sin_cos(2 * quarter, &sin, &cos);
+    TEST_ASSERT_EQUAL(0, sin);
+    TEST_ASSERT_EQUAL(-KINEMATICS_SINE_ONE, cos);
+    scanner_kinematics::sin_cos(3 * quarter, &sin, &cos);
+    TEST_ASSERT_EQUAL(-KINEMATICS_SINE_ONE, sin);
+    TEST_ASSERT_EQUAL(0, cos);
+
+    // Any number of turns
+    int32_t sin_turn, cos_turn;
+    scanner_kinematics::sin_cos(123, &sin, &cos);
+    scanner_kinematics::sin_cos(123 + 5 * scanner_kinematics::steps, &sin_turn, &cos_turn);
+    TEST_ASSERT_EQUAL(sin, sin_turn);
+    TEST_ASSERT_EQUAL(cos, cos_turn);
+}
+
+/**
+ * @brief Every turntable step at every radius a `uint16_t` holds, against double precision sin and cos
+ */
+void test_polar_to_xy_sweep() {
+    std::vector<double> sin_table(scanner_kinematics::steps), cos_table(scanner_kinematics::steps);
+    for (uint32_t step = 0; step < scanner_kinematics::steps; step++) {
+        double angle = step * MOTOR1_DEFAULT_MICRO_STEP_DEGREE * PI / 180;
+        sin_table[step] = sin(angle);
+        cos_table[step] = cos(angle);
+    }
+
+    double worst = 0;
+    uint32_t worst_step = 0;
+    uint16_t worst_r = 0;
+    for (uint32_t step = 0; step < scanner_kinematics::steps; step++) {
+        for (uint32_t r = 0; r <= UINT16_MAX; r++) {
+            int32_t x, y;
+            scanner_kinematics::polar_to_xy(step, r, &x, &y);
+            double error = max(fabs(x - r * cos_table[step]), fabs(y - r * sin_table[step]));
+            if (error > worst) {
+                worst = error;
+                worst_step = step;
+                worst_r = r;
+            }
+        }
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "worst error %.5f mm at step %u, r = %.2f mm", worst / 100, worst_step, worst_r / 100.0);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_OR_EQUAL(MAX_ERROR, worst);
+}
+
+void test_z() {
+    for (uint32_t z_steps = 0; z_steps < 1000000; z_steps++) {
+        TEST_ASSERT_EQUAL((int32_t)lround(z_steps * 1250 / 10000.0), scanner_kinematics::z(z_steps));
+    }
+    TEST_ASSERT_EQUAL(125, scanner_kinematics::z(1000));
+}
+
+void test_benchmark() {
+    const uint32_t points = 4000000;
+    char message[96];
+
+    double sum_double = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < points; i++) {
+        double x, y;
+        get_x_y_double(i % scanner_kinematics::steps * MOTOR1_DEFAULT_MICRO_STEP_DEGREE, (i % 60000) / 100.0, &x, &y);
+        sum_double += x + y;
+    }
+    double double_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / points;
+
+    int64_t sum_fixed = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < points; i++) {
+        int32_t x, y;
+        scanner_kinematics::polar_to_xy(i, i % 60000, &x, &y);
+        sum_fixed += x + y;
+    }
+    double fixed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / points;
+
+    snprintf(message, sizeof(message), "double get_x_y: %.2f ns per point, polar_to_xy: %.2f ns per point on the host", double_ns, fixed_ns);
+    TEST_MESSAGE(message);
+    // Both sum the same points, apart from the rounding of each one
+    TEST_ASSERT_DOUBLE_WITHIN(points * 2 * MAX_ERROR, sum_double * 100, (double)sum_fixed);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_table_quadrants);
+    RUN_TEST(test_polar_to_xy_sweep);
+    RUN_TEST(test_z);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+// Path: test/test_planner/test_main.cpp
+#include <unity.h>
+
+#include <chrono>
+
+#include "components/planner.h"
+
+// The NVS defaults of include/components/data.h, the start speed is 500000 / delay time
+#define Z_START_SPEED   (500000 / 100)
+#define Z_MAX_SPEED     10000
+#define Z_ACCELERATION  20000
+#define X_Y_START_SPEED (500000 / 50)
+#define X_Y_MAX_SPEED   16000
+#define X_Y_ACCELERATION 40000
+
+static const uint32_t lengths[] = { 1, 2, 7, 40, 400, 1600, 6400, 25600, 102400 };
+
+void setUp() {
+    planner_set_config(STEPPER_AXIS_Z, Z_START_SPEED, Z_MAX_SPEED, Z_ACCELERATION, 0);
+    planner_set_config(STEPPER_AXIS_X_Y, X_Y_START_SPEED, X_Y_MAX_SPEED, X_Y_ACCELERATION, 0);
+}
+
+void tearDown() {}
+
+/**
+ * @brief The segments add up to the move, ramp up, cruise and ramp down mirrored
+ */
+static void check_plan(uint8_t axis, uint32_t steps, uint32_t start_speed, uint32_t max_speed) {
+    stepper_segment_t segments[STEPPER_MAX_SEGMENTS];
+    uint8_t count = planner_plan(axis, steps, segments);
+    TEST_ASSERT_EQUAL(2 * PLANNER_RAMP_SEGMENTS + 1, count);
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++) total += segments[i].steps;
+    TEST_ASSERT_EQUAL(steps, total);
+
+    uint32_t start_half_period = 500000 / start_speed;
+    uint32_t max_half_period = 500000 / max_speed;
+    for (uint8_t i = 0; i < PLANNER_RAMP_SEGMENTS; i++) {
+        const stepper_segment_t* up = &segments[i];
+        const stepper_segment_t* down = &segments[count - 1 - i];
+        TEST_ASSERT_EQUAL(up->steps, down->steps);
+        TEST_ASSERT_EQUAL(up->half_period_us, down->half_period_us);
+        TEST_ASSERT_LESS_OR_EQUAL(start_half_period, up->half_period_us);
+        TEST_ASSERT_GREATER_OR_EQUAL(max_half_period, up->half_period_us);
+        if (i > 0) TEST_ASSERT_LESS_OR_EQUAL(segments[i - 1].half_period_us, up->half_period_us);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(segments[PLANNER_RAMP_SEGMENTS - 1].half_period_us, segments[PLANNER_RAMP_SEGMENTS].half_period_us);
+}
+
+void test_plan_covers_move() {
+    for (uint32_t steps = 1; steps <= 5000; steps++) {
+        check_plan(STEPPER_AXIS_Z, steps, Z_START_SPEED, Z_MAX_SPEED);
+    }
+    for (uint32_t steps : lengths) {
+        check_plan(STEPPER_AXIS_X_Y, steps, X_Y_START_SPEED, X_Y_MAX_SPEED);
+    }
+}
+
+void test_plan_s_curve() {
+    planner_set_config(STEPPER_AXIS_Z, Z_START_SPEED, Z_MAX_SPEED, Z_ACCELERATION, 200000);
+    for (uint32_t steps : lengths) {
+        check_plan(STEPPER_AXIS_Z, steps, Z_START_SPEED, Z_MAX_SPEED);
+    }
+}
+
+void test_fixed_rate() {
+    stepper_segment_t segments[STEPPER_MAX_SEGMENTS];
+    planner_set_config(STEPPER_AXIS_Z, Z_START_SPEED, Z_MAX_SPEED, 0, 0);
+    TEST_ASSERT_EQUAL(1, planner_plan(STEPPER_AXIS_Z, 400, segments));
+    TEST_ASSERT_EQUAL(400, segments[0].steps);
+    TEST_ASSERT_EQUAL(100, segments[0].half_period_us);
+    TEST_ASSERT_EQUAL(400 * 200, planner_move_time_us(segments, 1));
+
+    TEST_ASSERT_EQUAL(0, planner_plan(STEPPER_AXIS_Z, 0, segments));
+    TEST_ASSERT_EQUAL(0, planner_plan(STEPPER_AXIS_COUNT, 400, segments));
+}
+
+/**
+ * @brief Planned move time against the fixed rate of the delay time every move ran at before the planner
+ */
+static void benchmark_axis(const char* name, uint8_t axis, uint32_t start_speed) {
+    char message[128];
+    stepper_segment_t segments[STEPPER_MAX_SEGMENTS];
+
+    for (uint32_t steps : lengths) {
+        uint8_t count = planner_plan(axis, steps, segments);
+        uint64_t planned_us = planner_move_time_us(segments, count);
+        uint64_t baseline_us = (uint64_t)steps * (500000 / start_speed) * 2;
+
+        snprintf(message, sizeof(message), "%s %6u steps: %9llu us planned, %9llu us fixed rate, %5.1f%%", name, steps,
+                 (unsigned long long)planned_us, (unsigned long long)baseline_us, 100.0 * planned_us / baseline_us);
+        TEST_MESSAGE(message);
+
+        // A ramp never runs slower than the start speed, long moves spend most of their time at the max speed
+        TEST_ASSERT_LESS_OR_EQUAL(baseline_us, planned_us);
+        if (steps >= 6400) TEST_ASSERT_LESS_THAN(baseline_us * 3 / 4, planned_us);
+    }
+
+    const uint32_t runs = 10000;
+    auto start = std::chrono::steady_clock::now();
+    uint32_t sink = 0;
+    for (uint32_t i = 0; i < runs; i++) sink += planner_plan(axis, 400 + i, segments);
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    snprintf(message, sizeof(message), "%s planner_plan: %.2f us per move on the host", name, elapsed / runs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(runs * (2 * PLANNER_RAMP_SEGMENTS + 1), sink);
+}
+
+void test_benchmark_z() {
+    benchmark_axis("Z", STEPPER_AXIS_Z, Z_START_SPEED);
+}
+
+void test_benchmark_x_y() {
+    benchmark_axis("X/Y", STEPPER_AXIS_X_Y, X_Y_START_SPEED);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_plan_covers_move);
+    RUN_TEST(test_plan_s_curve);
+    RUN_TEST(test_fixed_rate);
+    RUN_TEST(test_benchmark_z);
+    RUN_TEST(test_benchmark_x_y);
+    return UNITY_END();
+}
@@ -0,0 +1,327 @@
+// Path: test/test_recorder/test_main.cpp
+#include <unity.h>
+
+#include <vector>
+
+#include "components/module.h"
+
+// The records of one hand over
+#define BUFFER_RECORDS (RECORDER_BUFFER_SIZE / sizeof(recorder_record_t))
+#define RING_POINTS 100
+// Above what a uint16_t z_steps held
+#define Z_START 70000
+#define Z_RING_STEPS 400
+
+extern QueueHandle_t recorder_queue;
+void recorder_handle(const recorder_message_t* message);
+void recorder_sync();
+
+/**
+ * @brief Point `seq` of a scan of `RING_POINTS` points per ring, every tenth one sees no surface
+ */
+static scanner_point_t make_point(uint32_t seq) {
+    scanner_point_t point;
+    point.seq = seq;
+    point.time_ms = seq * 20;
+    point.z_steps = Z_START + seq / RING_POINTS * Z_RING_STEPS;
+    point.x_y_steps = seq % RING_POINTS * 64;
+    point.r = seq % 10 == 0 ? 0 : 5000 + seq % 7;
+    point.flags = (seq % RING_POINTS == 0 ? POINT_FLAG_RING : 0) | (seq % 10 == 0 ? POINT_FLAG_NO_SURFACE : 0);
+    return point;
+}
+
+/**
+ * @brief Run the messages the recorder task would take
+ */
+static void drain() {
+    recorder_message_t message;
+    while (xQueueReceive(recorder_queue, &message, 0) == pdTRUE) recorder_handle(&message);
+}
+
+static void push(uint32_t first, uint32_t count, bool keep_up) {
+    for (uint32_t seq = first; seq < first + count; seq++) {
+        scanner_point_t point = make_point(seq);
+        recorder_push(&point);
+        if (keep_up) drain();
+    }
+}
+
+static recorder_header_t read_header(const char* name) {
+    recorder_header_t header;
+    memset(&header, 0, sizeof(header));
+    File file = SD.open((recorder_path(name) + ".bin").c_str(), FILE_READ);
+    TEST_ASSERT_TRUE(file);
+    TEST_ASSERT_EQUAL(sizeof(header), file.read((uint8_t*)&header, sizeof(header)));
+    return header;
+}
+
+static std::vector<recorder_record_t> read_records(const char* name) {
+    recorder_header_t header = read_header(name);
+    std::vector<recorder_record_t> records(header.records);
+    File file = SD.open((recorder_path(name) + ".bin").c_str(), FILE_READ);
+    file.seek(RECORDER_HEADER_SIZE);
+    TEST_ASSERT_EQUAL(header.records, recorder_read_records(file, header.record_size, records.data(), records.size()));
+    return records;
+}
+
+/**
+ * @brief The index up to the end the catalogue has, a resume leaves the entries after it in the file
+ */
+static std::vector<recorder_index_t> read_index(const char* name, uint32_t index_end) {
+    std::vector<recorder_index_t> entries(index_end / sizeof(recorder_index_t));
+    File file = SD.open((recorder_path(name) + ".idx").c_str(), FILE_READ);
+    TEST_ASSERT_TRUE(file);
+    TEST_ASSERT_EQUAL(index_end, file.read((uint8_t*)entries.data(), index_end));
+    return entries;
+}
+
+/**
+ * @brief The records are points `first` to `first + count`, the index has one entry per ring at the right offset
+ */
+static void check_recording(const char* name, uint32_t first, uint32_t count) {
+    std::vector<recorder_record_t> records = read_records(name);
+    TEST_ASSERT_EQUAL(count, records.size());
+
+    uint32_t surface = 0;
+    uint32_t rings = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        scanner_point_t point = make_point(first + i);
+        TEST_ASSERT_EQUAL(point.seq, records[i].seq);
+        TEST_ASSERT_EQUAL(point.time_ms, records[i].time_ms);
+        TEST_ASSERT_EQUAL(point.z_steps, records[i].z_steps);
+        TEST_ASSERT_EQUAL(point.x_y_steps, records[i].x_y_steps);
+        TEST_ASSERT_EQUAL(point.r, records[i].r);
+        TEST_ASSERT_EQUAL(point.flags, records[i].flags);
+        if (!(point.flags & POINT_FLAG_NO_SURFACE)) surface++;
+        if (point.flags & POINT_FLAG_RING) rings++;
+    }
+
+    recorder_header_t header = read_header(name);
+    TEST_ASSERT_EQUAL_MEMORY(RECORDER_MAGIC, header.magic, sizeof(header.magic));
+    TEST_ASSERT_EQUAL(RECORDER_VERSION, header.version);
+    TEST_ASSERT_EQUAL(sizeof(recorder_record_t), header.record_size);
+    TEST_ASSERT_EQUAL(RECORDER_HEADER_SIZE, header.header_size);
+    TEST_ASSERT_EQUAL_STRING(name, header.name);
+    TEST_ASSERT_EQUAL(surface, header.surface);
+
+    catalog_entry_t entry;
+    TEST_ASSERT_TRUE(catalog_get(name, &entry));
+    TEST_ASSERT_EQUAL(count, entry.records);
+    TEST_ASSERT_EQUAL(surface, entry.surface);
+    TEST_ASSERT_EQUAL(RECORDER_HEADER_SIZE + count * sizeof(recorder_record_t), entry.data_end);
+
+    std::vector<recorder_index_t> entries = read_index(name, entry.index_end);
+    TEST_ASSERT_EQUAL(rings, entries.size());
+    for (const recorder_index_t& ring : entries) {
+        uint32_t i = (ring.offset - RECORDER_HEADER_SIZE) / sizeof(recorder_record_t);
+        TEST_ASSERT_EQUAL(0, (ring.offset - RECORDER_HEADER_SIZE) % sizeof(recorder_record_t));
+        TEST_ASSERT_TRUE(records[i].flags & POINT_FLAG_RING);
+        TEST_ASSERT_EQUAL(records[i].seq, ring.seq);
+        TEST_ASSERT_EQUAL(records[i].z_steps, ring.z_steps);
+    }
+}
+
+void setUp() {
+    init_recorder();
+    TEST_ASSERT_TRUE(recorder_ready());
+}
+
+void tearDown() {
+    recorder_stop();
+    drain();
+    SD.end();
+}
+
+void test_record() {
+    recorder_start("cup");
+    push(0, 3 * BUFFER_RECORDS + 17, true);
+    recorder_stop();
+    drain();
+
+    check_recording("cup", 0, 3 * BUFFER_RECORDS + 17);
+    TEST_ASSERT_EQUAL(0, read_header("cup").dropped);
+    TEST_ASSERT_EQUAL(3 * BUFFER_RECORDS + 17, recorder_get_stats().records);
+
+    catalog_entry_t entry;
+    TEST_ASSERT_TRUE(catalog_get("cup", &entry));
+    TEST_ASSERT_EQUAL(CATALOG_STATE_DONE, entry.state);
+    TEST_ASSERT_EQUAL(get_z(Z_START), entry.min_z);
+}
+
+void test_file_name() {
+    recorder_start("a cup/1");
+    push(0, 10, true);
+    recorder_stop();
+    drain();
+    TEST_ASSERT_TRUE(SD.exists("/scans/a_cup_1.bin"));
+    TEST_ASSERT_EQUAL_STRING("a cup/1", read_header("a cup/1").name);
+}
+
+void test_sync_before_stop() {
+    recorder_start("vase");
+    push(0, BUFFER_RECORDS + 5, true);
+    recorder_sync();
+
+    // What the card holds at a sync, the partial buffer is still in RAM
+    recorder_header_t header = read_header("vase");
+    TEST_ASSERT_EQUAL(BUFFER_RECORDS, header.records);
+    catalog_entry_t entry;
+    TEST_ASSERT_TRUE(catalog_get("vase", &entry));
+    TEST_ASSERT_EQUAL(CATALOG_STATE_RECORDING, entry.state);
+    TEST_ASSERT_EQUAL(BUFFER_RECORDS, entry.records);
+}
+
+void test_flush() {
+    TEST_ASSERT_TRUE(recorder_flush());
+
+    recorder_start("jar");
+    push(0, BUFFER_RECORDS + 5, true);
+    // The recorder task never runs here, so the confirmation does not come
+    TEST_ASSERT_FALSE(recorder_flush());
+    drain();
+
+    // The partial buffer, the header and the index are on the card before the checkpoint
+    TEST_ASSERT_EQUAL(BUFFER_RECORDS + 5, read_header("jar").records);
+    catalog_entry_t entry;
+    TEST_ASSERT_TRUE(catalog_get("jar", &entry));
+    TEST_ASSERT_EQUAL(RECORDER_HEADER_SIZE + (BUFFER_RECORDS + 5) * sizeof(recorder_record_t), entry.data_end);
+    TEST_ASSERT_EQUAL(sizeof(recorder_index_t) * ((BUFFER_RECORDS + 5 + RING_POINTS - 1) / RING_POINTS), entry.index_end);
+
+    // Recording goes on into the other buffer
+    push(BUFFER_RECORDS + 5, 10, true);
+    recorder_stop();
+    drain();
+    check_recording("jar", 0, BUFFER_RECORDS + 15);
+}
+
+void test_card_behind() {
+    recorder_start("behind");
+    drain();
+    // Both buffers wait for the card, the third one's worth of points is lost
+    push(0, 3 * BUFFER_RECORDS, false);
+    TEST_ASSERT_EQUAL(BUFFER_RECORDS, recorder_get_stats().dropped);
+    drain();
+    recorder_stop();
+    drain();
+
+    TEST_ASSERT_EQUAL(2 * BUFFER_RECORDS, read_header("behind").records);
+    TEST_ASSERT_EQUAL(BUFFER_RECORDS, read_header("behind").dropped);
+}
+
+void test_queue_full() {
+    recorder_start("full");
+    drain();
+
+    // Messages the recorder task ignores, the queue has no room for the next buffer
+    recorder_message_t filler;
+    memset(&filler, 0, sizeof(filler));
+    filler.type = 0xFF;
+    while (xQueueSend(recorder_queue, &filler, 0) == pdTRUE) {}
+
+    push(0, BUFFER_RECORDS, false);
+    TEST_ASSERT_EQUAL(BUFFER_RECORDS, recorder_get_stats().dropped);
+    drain();
+    push(BUFFER_RECORDS, 10, true);
+    recorder_stop();
+    drain();
+
+    recorder_header_t header = read_header("full");
+    TEST_ASSERT_EQUAL(10, header.records);
+    TEST_ASSERT_EQUAL(BUFFER_RECORDS, header.dropped);
+}
+
+void test_resume() {
+    const uint32_t total = 7 * RING_POINTS + 30;
+    recorder_start("bowl");
+    push(0, total, true);
+    recorder_stop();
+    drain();
+
+    // The scan went on to the middle of ring 4, it resumes after the last point of ring 2
+    recorder_resume("bowl", 3 * RING_POINTS - 1);
+    drain();
+    push(3 * RING_POINTS, 2 * RING_POINTS, true);
+    recorder_stop();
+    drain();
+    check_recording("bowl", 0, 5 * RING_POINTS);
+
+    // A resume in the middle of a ring keeps the whole ring
+    recorder_resume("bowl", 4 * RING_POINTS + 50);
+    drain();
+    push(5 * RING_POINTS, 10, true);
+    recorder_stop();
+    drain();
+    check_recording("bowl", 0, 5 * RING_POINTS + 10);
+}
+
+void test_resume_without_recording() {
+    recorder_resume("new", 1000);
+    drain();
+    push(0, 20, true);
+    recorder_stop();
+    drain();
+    check_recording("new", 0, 20);
+}
+
+void test_legacy_records() {
+    // A version 2 recording written by hand, 16 byte records with a uint16_t z_steps
+    const uint32_t count = 40;
+    recorder_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RECORDER_MAGIC, sizeof(header.magic));
+    header.version = 2;
+    header.record_size = sizeof(recorder_record_v2_t);
+    header.header_size = RECORDER_HEADER_SIZE;
+    header.records = count;
+
+    File file = SD.open("/scans/old.bin", FILE_WRITE);
+    uint8_t block[RECORDER_HEADER_SIZE] = { 0 };
+    memcpy(block, &header, sizeof(header));
+    file.write(block, sizeof(block));
+    for (uint32_t seq = 0; seq < count; seq++) {
+        recorder_record_v2_t record = { seq, seq * 20, (uint16_t)(60000 + seq), (uint16_t)(seq * 64), 5000, (uint8_t)(seq % 2), 0 };
+        file.write((const uint8_t*)&record, sizeof(record));
+    }
+    file.close();
+
+    TEST_ASSERT_TRUE(recorder_record_size_valid(header.record_size));
+    TEST_ASSERT_TRUE(recorder_record_size_valid(sizeof(recorder_record_t)));
+    TEST_ASSERT_FALSE(recorder_record_size_valid(12));
+
+    // More than one read, the last one short
+    std::vector<recorder_record_t> records(50);
+    file = SD.open("/scans/old.bin", FILE_READ);
+    file.seek(RECORDER_HEADER_SIZE);
+    TEST_ASSERT_EQUAL(25, recorder_read_records(file, header.record_size, records.data(), 25));
+    TEST_ASSERT_EQUAL(count - 25, recorder_read_records(file, header.record_size, records.data() + 25, 25));
+    for (uint32_t seq = 0; seq < count; seq++) {
+        TEST_ASSERT_EQUAL(seq, records[seq].seq);
+        TEST_ASSERT_EQUAL(seq * 20, records[seq].time_ms);
+        TEST_ASSERT_EQUAL(60000 + seq, records[seq].z_steps);
+        TEST_ASSERT_EQUAL(seq * 64, records[seq].x_y_steps);
+        TEST_ASSERT_EQUAL(5000, records[seq].r);
+        TEST_ASSERT_EQUAL(seq % 2, records[seq].flags);
+    }
+
+    // A resume does not append wide records to it
+    recorder_resume("old", 10);
+    drain();
+    push(0, 5, true);
+    recorder_stop();
+    drain();
+    check_recording("old", 0, 5);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_record);
+    RUN_TEST(test_file_name);
+    RUN_TEST(test_sync_before_stop);
+    RUN_TEST(test_flush);
+    RUN_TEST(test_card_behind);
+    RUN_TEST(test_queue_full);
+    RUN_TEST(test_resume);
+    RUN_TEST(test_resume_without_recording);
+    RUN_TEST(test_legacy_records);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+// Path: test/test_skip/test_main.cpp
+#include <unity.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "components/skip.h"
+
+static skip_t skip;
+
+void setUp() {}
+
+void tearDown() {}
+
+typedef struct {
+    std::vector<uint32_t> visited;  // points kept, in the order they were taken
+    uint32_t rangings;              // points ranged, kept or thrown away by a step back
+} walk_t;
+
+/**
+ * @brief One ring of `scan_step_loop` in src/components/module.cpp over a surface profile, positions in points
+ */
+static walk_t walk(const std::vector<bool>& surface, uint16_t stride) {
+    walk_t result = {{}, 0};
+    skip_begin(&skip, stride);
+    uint32_t position = 0;
+    while (position < surface.size()) {
+        result.rangings++;
+        uint16_t back = skip_check(&skip, position, surface[position]);
+        if (back > 0) {
+            position -= back;
+            continue;
+        }
+        result.visited.push_back(position);
+        position += skip_points(&skip);
+    }
+    return result;
+}
+
+static std::vector<bool> profile(size_t points, size_t first, size_t last) {
+    std::vector<bool> surface(points, false);
+    for (size_t i = first; i <= last && i < points; i++) surface[i] = true;
+    return surface;
+}
+
+void test_off() {
+    walk_t result = walk(profile(20, 5, 8), 0);
+    TEST_ASSERT_EQUAL_UINT32(20, result.visited.size());
+    TEST_ASSERT_EQUAL_UINT32(20, result.rangings);
+    for (uint32_t i = 0; i < 20; i++) TEST_ASSERT_EQUAL_UINT32(i, result.visited[i]);
+}
+
+void test_step_back_keeps_the_surface() {
+    // The stride ends at 26 inside the surface, the step back must not stride over 25 again from 21
+    walk_t result = walk(profile(48, 25, 35), 8);
+    std::vector<uint32_t> expected = {0, 1, 2, 10, 18};
+    for (uint32_t i = 19; i <= 38; i++) expected.push_back(i);
+    expected.push_back(46);
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), result.visited.size());
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected.data(), result.visited.data(), expected.size());
+    // The ranging at 26 is the only one thrown away
+    TEST_ASSERT_EQUAL_UINT32(expected.size() + 1, result.rangings);
+}
+
+void test_wide_stride_beats_plain_stepping() {
+    for (uint16_t stride = 2; stride <= 32; stride++) {
+        walk_t result = walk(profile(400, 150, 249), stride);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(400, result.rangings);
+        for (uint32_t i = 150; i <= 249; i++) {
+            TEST_ASSERT_TRUE(std::find(result.visited.begin(), result.visited.end(), i) != result.visited.end());
+        }
+    }
+}
+
+void test_random_profiles() {
+    std::mt19937 rng(12);
+    for (uint32_t ring = 0; ring < 2000; ring++) {
+        // Runs of surface and of nothing, none narrower than the widest stride
+        std::vector<bool> surface;
+        bool on = std::uniform_int_distribution<uint32_t>(0, 1)(rng);
+        for (uint32_t runs = std::uniform_int_distribution<uint32_t>(1, 10)(rng); runs > 0; runs--) {
+            surface.insert(surface.end(), std::uniform_int_distribution<uint32_t>(16, 60)(rng), on);
+            on = !on;
+        }
+        uint16_t stride = std::uniform_int_distribution<uint32_t>(2, 16)(rng);
+        walk_t result = walk(surface, stride);
+
+        // Taken in turntable order, each point once
+        for (size_t i = 1; i < result.visited.size(); i++) TEST_ASSERT_GREATER_THAN_UINT32(result.visited[i - 1], result.visited[i]);
+        // A stride only skips empty points, the surface behind it is scanned again
+        std::vector<bool> seen(surface.size(), false);
+        for (uint32_t position : result.visited) seen[position] = true;
+        for (size_t i = 0; i < surface.size(); i++) {
+            if (surface[i]) TEST_ASSERT_TRUE(seen[i]);
+        }
+        // At most one thrown away ranging per surface that a stride ran into
+        uint32_t surfaces = 0;
+        for (size_t i = 0; i < surface.size(); i++) {
+            if (surface[i] && (i == 0 || !surface[i - 1])) surfaces++;
+        }
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(result.visited.size() + surfaces, result.rangings);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_off);
+    RUN_TEST(test_step_back_keeps_the_surface);
+    RUN_TEST(test_wide_stride_beats_plain_stepping);
+    RUN_TEST(test_random_profiles);
+    return UNITY_END();
+}
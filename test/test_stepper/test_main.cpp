@@ -0,0 +1,161 @@
+// Path: test/test_stepper/test_main.cpp
+#include <unity.h>
+
+#include <vector>
+
+#include "components/stepper.h"
+#include "components/planner.h"
+
+extern stepper_axis_t stepper_axes[STEPPER_AXIS_COUNT];
+
+// A rising edge of the STEP pin, in µs from the start of the move
+typedef struct {
+    uint64_t time_us;
+    uint32_t half_period_us;    // of the segment the step belongs to
+} edge_t;
+
+/**
+ * @brief Run the timer ISR of an axis until it stops, the alarm after each edge is the half period it left
+ *
+ * @param home_after `int32_t`: rising edges before the home switch closes, `-1` for never
+ * @return `uint64_t`: the time the ISR stopped the timer
+ */
+static uint64_t replay(uint8_t axis, std::vector<edge_t>* edges, int32_t home_after = -1) {
+    stepper_axis_t* a = &stepper_axes[axis];
+    uint64_t time_us = 0;
+    uint32_t wait_us = a->half_period_us;
+    for (;;) {
+        time_us += wait_us;
+        bool home_active = home_after >= 0 && (int32_t)edges->size() >= home_after;
+        bool running = stepper_next_edge(a, home_active);
+        if (a->level) edges->push_back({ time_us, a->half_period_us });
+        if (!running) return time_us;
+        wait_us = a->half_period_us;
+    }
+}
+
+void setUp() {
+    stepper_init(STEPPER_AXIS_Z, 25, 26);
+    stepper_init(STEPPER_AXIS_X_Y, 27, 13);
+}
+
+void tearDown() {}
+
+void test_constant_rate() {
+    std::vector<edge_t> edges;
+    TEST_ASSERT_TRUE(stepper_move(STEPPER_AXIS_Z, HIGH, 100, 250));
+    TEST_ASSERT_FALSE(stepper_move(STEPPER_AXIS_Z, HIGH, 100, 250));
+
+    uint64_t end_us = replay(STEPPER_AXIS_Z, &edges);
+    TEST_ASSERT_EQUAL(100, edges.size());
+    TEST_ASSERT_EQUAL(250, edges[0].time_us);
+    for (size_t i = 1; i < edges.size(); i++) {
+        TEST_ASSERT_EQUAL(500, edges[i].time_us - edges[i - 1].time_us);
+    }
+    TEST_ASSERT_EQUAL(100 * 500, end_us);
+    TEST_ASSERT_EQUAL(100, stepper_get_position(STEPPER_AXIS_Z));
+    TEST_ASSERT_FALSE(stepper_is_busy(STEPPER_AXIS_Z));
+}
+
+void test_min_half_period() {
+    std::vector<edge_t> edges;
+    stepper_move(STEPPER_AXIS_X_Y, LOW, 10, 0);
+    replay(STEPPER_AXIS_X_Y, &edges);
+    TEST_ASSERT_EQUAL(10, edges.size());
+    for (size_t i = 1; i < edges.size(); i++) {
+        TEST_ASSERT_EQUAL(2 * STEPPER_MIN_HALF_PERIOD_US, edges[i].time_us - edges[i - 1].time_us);
+    }
+    TEST_ASSERT_EQUAL(-10, stepper_get_position(STEPPER_AXIS_X_Y));
+}
+
+/**
+ * @brief Every step of a planned move keeps the rate of its segment, the ISR switches segments without a gap
+ */
+static void check_planned_move(uint32_t steps, uint32_t start_speed, uint32_t max_speed, uint32_t acceleration, uint32_t jerk) {
+    planner_set_config(STEPPER_AXIS_Z, start_speed, max_speed, acceleration, jerk);
+    stepper_segment_t segments[STEPPER_MAX_SEGMENTS];
+    uint8_t count = planner_plan(STEPPER_AXIS_Z, steps, segments);
+
+    // The rate of every step as the segments lay it out
+    std::vector<uint32_t> planned;
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint32_t j = 0; j < segments[i].steps; j++) {
+            planned.push_back(max(segments[i].half_period_us, (uint32_t)STEPPER_MIN_HALF_PERIOD_US));
+        }
+    }
+    TEST_ASSERT_EQUAL(steps, planned.size());
+
+    std::vector<edge_t> edges;
+    stepper_set_position(STEPPER_AXIS_Z, 0);
+    TEST_ASSERT_TRUE(stepper_move_segments(STEPPER_AXIS_Z, HIGH, segments, count));
+    uint64_t end_us = replay(STEPPER_AXIS_Z, &edges);
+
+    TEST_ASSERT_EQUAL(steps, edges.size());
+    TEST_ASSERT_EQUAL(planned[0], edges[0].time_us);
+    for (size_t i = 1; i < edges.size(); i++) {
+        // High time of the step before, low time of this one
+        TEST_ASSERT_EQUAL(planned[i - 1] + planned[i], edges[i].time_us - edges[i - 1].time_us);
+        TEST_ASSERT_EQUAL(planned[i], edges[i].half_period_us);
+    }
+    TEST_ASSERT_EQUAL(planner_move_time_us(segments, count), end_us);
+    TEST_ASSERT_EQUAL(steps, stepper_get_position(STEPPER_AXIS_Z));
+}
+
+void test_planned_trapezoid() {
+    check_planned_move(20000, 500, 10000, 20000, 0);
+}
+
+void test_planned_s_curve() {
+    check_planned_move(20000, 500, 10000, 20000, 200000);
+}
+
+void test_planned_short_move() {
+    check_planned_move(37, 500, 10000, 20000, 0);
+}
+
+void test_max_limit() {
+    std::vector<edge_t> edges;
+    stepper_set_limit(STEPPER_AXIS_Z, 0, 10);
+    stepper_move(STEPPER_AXIS_Z, HIGH, 50, 100);
+    replay(STEPPER_AXIS_Z, &edges);
+    TEST_ASSERT_EQUAL(10, edges.size());
+    TEST_ASSERT_EQUAL(10, stepper_get_position(STEPPER_AXIS_Z));
+    TEST_ASSERT_FALSE(stepper_is_busy(STEPPER_AXIS_Z));
+}
+
+void test_home_switch() {
+    std::vector<edge_t> edges;
+    stepper_set_position(STEPPER_AXIS_Z, 1000);
+    stepper_move(STEPPER_AXIS_Z, LOW, 500, 100);
+    replay(STEPPER_AXIS_Z, &edges, 20);
+    TEST_ASSERT_EQUAL(20, edges.size());
+    TEST_ASSERT_EQUAL(980, stepper_get_position(STEPPER_AXIS_Z));
+
+    // The switch only stops moves down
+    edges.clear();
+    stepper_move(STEPPER_AXIS_Z, HIGH, 5, 100);
+    replay(STEPPER_AXIS_Z, &edges, 0);
+    TEST_ASSERT_EQUAL(5, edges.size());
+}
+
+void test_stop() {
+    stepper_move(STEPPER_AXIS_Z, HIGH, 100, 100);
+    stepper_next_edge(&stepper_axes[STEPPER_AXIS_Z], false);
+    stepper_stop(STEPPER_AXIS_Z);
+    TEST_ASSERT_FALSE(stepper_is_busy(STEPPER_AXIS_Z));
+    TEST_ASSERT_EQUAL(1, stepper_get_position(STEPPER_AXIS_Z));
+    TEST_ASSERT_TRUE(stepper_move(STEPPER_AXIS_Z, HIGH, 1, 100));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_constant_rate);
+    RUN_TEST(test_min_half_period);
+    RUN_TEST(test_planned_trapezoid);
+    RUN_TEST(test_planned_s_curve);
+    RUN_TEST(test_planned_short_move);
+    RUN_TEST(test_max_limit);
+    RUN_TEST(test_home_switch);
+    RUN_TEST(test_stop);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+// Path: test/test_vl53l1x/test_main.cpp
+#include <unity.h>
+
+#include "components/vl53l1x.h"
+
+#define ADDRESS 0x29
+
+void setUp() {
+    memset(Wire.registers, 0, sizeof(Wire.registers));
+    Wire.transmissions = 0;
+    Wire.requests = 0;
+    Wire.nack = false;
+}
+
+void tearDown() {}
+
+/**
+ * @brief A finished measurement in the result registers, GPIO1 active high and asserted
+ */
+static void measurement(uint16_t distance, uint16_t signal, uint16_t ambient, uint8_t spads) {
+    Wire.registers[VL53L1X_GPIO_HV_MUX__CTRL] = 0x01;
+    Wire.registers[VL53L1X_GPIO__TIO_HV_STATUS] = 0x01;
+    uint8_t* raw = &Wire.registers[VL53L1X_RESULT__RANGE_STATUS];
+    raw[0] = 9;
+    raw[3] = spads;
+    raw[7] = ambient >> 8;
+    raw[8] = ambient & 0xFF;
+    raw[13] = distance >> 8;
+    raw[14] = distance & 0xFF;
+    raw[15] = signal >> 8;
+    raw[16] = signal & 0xFF;
+}
+
+void test_interrupt_read_is_burst_and_clear() {
+    measurement(123, 0x0100, 0x0010, 40);
+    uint8_t polarity;
+    TEST_ASSERT_TRUE(vl53l1x_read_polarity(&Wire, ADDRESS, &polarity));
+
+    vl53l1x_result_t result;
+    uint32_t transactions = vl53l1x_transactions();
+    uint32_t transmissions = Wire.transmissions;
+    TEST_ASSERT_TRUE(vl53l1x_read_sample(&Wire, ADDRESS, polarity, true, &result));
+    TEST_ASSERT_EQUAL_UINT32(2, vl53l1x_transactions() - transactions);
+    TEST_ASSERT_EQUAL_UINT32(2, Wire.transmissions - transmissions);
+    TEST_ASSERT_EQUAL_UINT8(VL53L1X_STATUS_VALID, result.status);
+    TEST_ASSERT_EQUAL_UINT16(123, result.distance);
+    TEST_ASSERT_EQUAL_UINT8(0x01, Wire.registers[VL53L1X_SYSTEM__INTERRUPT_CLEAR]);
+}
+
+void test_polled_read_adds_ready_flag() {
+    measurement(123, 0x0100, 0x0010, 40);
+    uint8_t polarity;
+    TEST_ASSERT_TRUE(vl53l1x_read_polarity(&Wire, ADDRESS, &polarity));
+
+    vl53l1x_result_t result;
+    uint32_t transactions = vl53l1x_transactions();
+    TEST_ASSERT_TRUE(vl53l1x_read_sample(&Wire, ADDRESS, polarity, false, &result));
+    TEST_ASSERT_EQUAL_UINT32(3, vl53l1x_transactions() - transactions);
+
+    // Not ready, the flag alone
+    Wire.registers[VL53L1X_GPIO__TIO_HV_STATUS] = 0x00;
+    transactions = vl53l1x_transactions();
+    TEST_ASSERT_FALSE(vl53l1x_read_sample(&Wire, ADDRESS, polarity, false, &result));
+    TEST_ASSERT_EQUAL_UINT32(1, vl53l1x_transactions() - transactions);
+}
+
+void test_polarity() {
+    uint8_t polarity;
+    Wire.registers[VL53L1X_GPIO_HV_MUX__CTRL] = 0x01;
+    TEST_ASSERT_TRUE(vl53l1x_read_polarity(&Wire, ADDRESS, &polarity));
+    TEST_ASSERT_EQUAL_UINT8(1, polarity);
+    Wire.registers[VL53L1X_GPIO_HV_MUX__CTRL] = 0x11;
+    TEST_ASSERT_TRUE(vl53l1x_read_polarity(&Wire, ADDRESS, &polarity));
+    TEST_ASSERT_EQUAL_UINT8(0, polarity);
+
+    Wire.registers[VL53L1X_GPIO__TIO_HV_STATUS] = 0x01;
+    TEST_ASSERT_TRUE(vl53l1x_data_ready(&Wire, ADDRESS, 1));
+    TEST_ASSERT_FALSE(vl53l1x_data_ready(&Wire, ADDRESS, 0));
+}
+
+void test_rates_are_totals() {
+    measurement(500, 0x0100, 0x0020, 64);
+    vl53l1x_result_t result;
+    TEST_ASSERT_TRUE(vl53l1x_read_result(&Wire, ADDRESS, &result));
+    TEST_ASSERT_EQUAL_UINT16(500, result.distance);
+    TEST_ASSERT_EQUAL_UINT16(0x0100 * 8, result.signal_rate);
+    TEST_ASSERT_EQUAL_UINT16(0x0020 * 8, result.ambient_rate);
+    TEST_ASSERT_EQUAL_UINT8(64, result.spads);
+}
+
+void test_no_answer() {
+    measurement(123, 0x0100, 0x0010, 40);
+    Wire.nack = true;
+    vl53l1x_result_t result;
+    uint32_t transactions = vl53l1x_transactions();
+    TEST_ASSERT_TRUE(vl53l1x_read_sample(&Wire, ADDRESS, 0, true, &result));
+    TEST_ASSERT_EQUAL_UINT8(255, result.status);
+    TEST_ASSERT_EQUAL_UINT32(2, vl53l1x_transactions() - transactions);
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.requests);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_interrupt_read_is_burst_and_clear);
+    RUN_TEST(test_polled_read_adds_ready_flag);
+    RUN_TEST(test_polarity);
+    RUN_TEST(test_rates_are_totals);
+    RUN_TEST(test_no_answer);
+    return UNITY_END();
+}